@@ -2,11 +2,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ast.h"
+#include "number_parser.h"
 
 /* Node creation functions */
-Node* create_object_node(Pair** pairs, int pair_count) {
+Node* create_object_node(Pair** pairs, size_t pair_count) {
     Node* node = malloc(sizeof(Node));
     node->type = NODE_OBJECT;
+    node->offset = 0;
     
     if (pairs && pair_count > 0) {
         node->data.object.pairs = pairs;
@@ -19,9 +21,10 @@ Node* create_object_node(Pair** pairs, int pair_count) {
     return node;
 }
 
-Node* create_array_node(Node** elements, int element_count) {
+Node* create_array_node(Node** elements, size_t element_count) {
     Node* node = malloc(sizeof(Node));
     node->type = NODE_ARRAY;
+    node->offset = 0;
     
     if (elements && element_count > 0) {
         node->data.array.elements = elements;
@@ -34,23 +37,26 @@ Node* create_array_node(Node** elements, int element_count) {
     return node;
 }
 
-Node* create_string_node(const char* value) {
+Node* create_string_node(JsonString value) {
     Node* node = malloc(sizeof(Node));
     node->type = NODE_STRING;
-    node->data.string_value = strdup(value);
+    node->offset = 0;
+    node->data.string = value;  /* Takes over an owned buffer */
     return node;
 }
 
-Node* create_number_node(double value) {
+Node* create_number_node(JsonString lexeme) {
     Node* node = malloc(sizeof(Node));
     node->type = NODE_NUMBER;
-    node->data.number_value = value;
+    node->offset = 0;
+    node->data.number = lexeme;
     return node;
 }
 
 Node* create_boolean_node(int value) {
     Node* node = malloc(sizeof(Node));
     node->type = NODE_BOOLEAN;
+    node->offset = 0;
     node->data.boolean_value = value;
     return node;
 }
@@ -58,16 +64,23 @@ Node* create_boolean_node(int value) {
 Node* create_null_node() {
     Node* node = malloc(sizeof(Node));
     node->type = NODE_NULL;
+    node->offset = 0;
     return node;
 }
 
+/* key must be interned; it is shared, not copied */
 Pair* create_pair_node(const char* key, Node* value) {
     Pair* pair = malloc(sizeof(Pair));
-    pair->key = strdup(key);
+    pair->key = key;
     pair->value = value;
     return pair;
 }
 
+/* Numeric value of a number node, converted from its lexeme on demand */
+double get_number_value(const Node* node) {
+    return parse_number(node->data.number.chars, node->data.number.length);
+}
+
 /* Node manipulation */
 void add_pair_to_object(Node* object, Pair* pair) {
     if (object->type != NODE_OBJECT) {
@@ -110,7 +123,7 @@ void print_ast(Node* node, int indent) {
     switch (node->type) {
         case NODE_OBJECT:
             printf("{\n");
-            for (int i = 0; i < node->data.object.pair_count; i++) {
+            for (size_t i = 0; i < node->data.object.pair_count; i++) {
                 Pair* pair = node->data.object.pairs[i];
                 print_indent(indent + 1);
                 printf("\"%s\": ", pair->key);
@@ -126,7 +139,7 @@ void print_ast(Node* node, int indent) {
             
         case NODE_ARRAY:
             printf("[\n");
-            for (int i = 0; i < node->data.array.element_count; i++) {
+            for (size_t i = 0; i < node->data.array.element_count; i++) {
                 print_indent(indent + 1);
                 print_ast(node->data.array.elements[i], indent + 1);
                 if (i < node->data.array.element_count - 1) {
@@ -139,11 +152,11 @@ void print_ast(Node* node, int indent) {
             break;
             
         case NODE_STRING:
-            printf("\"%s\"", node->data.string_value);
+            printf("\"%.*s\"", (int)node->data.string.length, node->data.string.chars);
             break;
             
         case NODE_NUMBER:
-            printf("%g", node->data.number_value);
+            printf("%.*s", (int)node->data.number.length, node->data.number.chars);
             break;
             
         case NODE_BOOLEAN:
@@ -162,24 +175,30 @@ void free_ast(Node* node) {
     
     switch (node->type) {
         case NODE_OBJECT:
-            for (int i = 0; i < node->data.object.pair_count; i++) {
-                Pair* pair = node->data.object.pairs[i];
-                free(pair->key);
-                free_ast(pair->value);
-                free(pair);
+            for (size_t i = 0; i < node->data.object.pair_count; i++) {
+                free_pair(node->data.object.pairs[i]);
             }
             free(node->data.object.pairs);
             break;
             
         case NODE_ARRAY:
-            for (int i = 0; i < node->data.array.element_count; i++) {
+            for (size_t i = 0; i < node->data.array.element_count; i++) {
                 free_ast(node->data.array.elements[i]);
             }
             free(node->data.array.elements);
             break;
             
         case NODE_STRING:
-            free(node->data.string_value);
+            if (node->data.string.owned) {
+                free((char*)node->data.string.chars);
+            }
+            break;
+
+        case NODE_NUMBER:
+            /* Copied by the push parser, whose input does not outlive a chunk */
+            if (node->data.number.owned) {
+                free((char*)node->data.number.chars);
+            }
             break;
             
         default:
@@ -190,11 +209,18 @@ void free_ast(Node* node) {
     free(node);
 }
 
+void free_pair(Pair* pair) {
+    if (!pair) return;
+
+    free_ast(pair->value);
+    free(pair);
+}
+
 /* Helper function to detect object structure */
 typedef struct KeySet {
-    char** keys;
-    int key_count;
-    char* table_name;
+    const char** keys;
+    size_t key_count;
+    const char* table_name;
     struct KeySet* next;
 } KeySet;
 
@@ -209,13 +235,13 @@ int compare_key_sets(Node* obj1, Node* obj2) {
     }
     
     /* Check if every key in obj1 is in obj2 */
-    for (int i = 0; i < obj1->data.object.pair_count; i++) {
-        char* key1 = obj1->data.object.pairs[i]->key;
+    for (size_t i = 0; i < obj1->data.object.pair_count; i++) {
+        const char* key1 = obj1->data.object.pairs[i]->key;
         int found = 0;
         
-        for (int j = 0; j < obj2->data.object.pair_count; j++) {
-            char* key2 = obj2->data.object.pairs[j]->key;
-            if (strcmp(key1, key2) == 0) {
+        for (size_t j = 0; j < obj2->data.object.pair_count; j++) {
+            const char* key2 = obj2->data.object.pairs[j]->key;
+            if (key1 == key2) {
                 found = 1;
                 break;
             }
@@ -237,12 +263,12 @@ KeySet* find_key_set(KeySet* list, Node* obj) {
         
         /* Check if object has all keys in key set */
         if (obj->data.object.pair_count == current->key_count) {
-            for (int i = 0; i < obj->data.object.pair_count; i++) {
-                char* key = obj->data.object.pairs[i]->key;
+            for (size_t i = 0; i < obj->data.object.pair_count; i++) {
+                const char* key = obj->data.object.pairs[i]->key;
                 int found = 0;
                 
-                for (int j = 0; j < current->key_count; j++) {
-                    if (strcmp(key, current->keys[j]) == 0) {
+                for (size_t j = 0; j < current->key_count; j++) {
+                    if (key == current->keys[j]) {
                         found = 1;
                         break;
                     }
@@ -270,11 +296,11 @@ KeySet* create_key_set(Node* obj, const char* name_hint) {
     KeySet* key_set = malloc(sizeof(KeySet));
     key_set->key_count = obj->data.object.pair_count;
     key_set->keys = malloc(key_set->key_count * sizeof(char*));
-    key_set->table_name = strdup(name_hint ? name_hint : "table");
+    key_set->table_name = name_hint ? name_hint : "table";
     key_set->next = NULL;
     
-    for (int i = 0; i < obj->data.object.pair_count; i++) {
-        key_set->keys[i] = strdup(obj->data.object.pairs[i]->key);
+    for (size_t i = 0; i < obj->data.object.pair_count; i++) {
+        key_set->keys[i] = obj->data.object.pairs[i]->key;
     }
     
     return key_set;
@@ -282,11 +308,7 @@ KeySet* create_key_set(Node* obj, const char* name_hint) {
 
 /* Free a key set */
 void free_key_set(KeySet* key_set) {
-    for (int i = 0; i < key_set->key_count; i++) {
-        free(key_set->keys[i]);
-    }
     free(key_set->keys);
-    free(key_set->table_name);
     free(key_set);
 }
 
@@ -296,7 +318,7 @@ KeySet* collect_key_sets(Node* node, KeySet* key_sets, const char* name_hint) {
     
     if (node->type == NODE_OBJECT) {
         /* Process each field in the object */
-        for (int i = 0; i < node->data.object.pair_count; i++) {
+        for (size_t i = 0; i < node->data.object.pair_count; i++) {
             Pair* pair = node->data.object.pairs[i];
             Node* value = pair->value;
             
@@ -321,21 +343,22 @@ KeySet* collect_key_sets(Node* node, KeySet* key_sets, const char* name_hint) {
 /* Create table from key set */
 Table* create_table_from_key_set(KeySet* key_set) {
     Table* table = malloc(sizeof(Table));
-    table->name = strdup(key_set->table_name);
+    table->name = key_set->table_name;
     
     /* Start with ID column, then all keys excluding objects and arrays */
     /* We'll handle those separately */
     table->column_count = 1;  /* Start with id column */
     table->columns = malloc(sizeof(char*) * (key_set->key_count + 1)); /* +1 for id */
-    table->columns[0] = strdup("id");
+    table->columns[0] = "id";
     
     /* Add all scalar keys */
-    int col_idx = 1;
-    for (int i = 0; i < key_set->key_count; i++) {
-        table->columns[col_idx++] = strdup(key_set->keys[i]);
+    size_t col_idx = 1;
+    for (size_t i = 0; i < key_set->key_count; i++) {
+        table->columns[col_idx++] = key_set->keys[i];
     }
     
     table->column_count = col_idx;
+    table->row_count = 0;
     table->next = NULL;
     
     return table;
@@ -353,7 +376,7 @@ Schema* analyze_ast(Node* root) {
     
     /* Process root object */
     if (root->type == NODE_OBJECT) {
-        for (int i = 0; i < root->data.object.pair_count; i++) {
+        for (size_t i = 0; i < root->data.object.pair_count; i++) {
             Pair* pair = root->data.object.pairs[i];
             Node* value = pair->value;
             
@@ -363,15 +386,16 @@ Schema* analyze_ast(Node* root) {
                 if (first->type == NODE_OBJECT) {
                     Table* table = malloc(sizeof(Table));
                     if (!table) continue;
-                    table->name = strdup(pair->key);
+                    table->name = pair->key;
                     table->next = schema->tables;
                     schema->tables = table;
                     schema->table_count++;
                     table->column_count = first->data.object.pair_count;
+                    table->row_count = 0;
                     table->columns = malloc(sizeof(char*) * table->column_count);
-                    for (int j = 0; j < first->data.object.pair_count; j++) {
+                    for (size_t j = 0; j < first->data.object.pair_count; j++) {
                         Pair* field = first->data.object.pairs[j];
-                        table->columns[j] = strdup(field->key);
+                        table->columns[j] = field->key;
                     }
                 }
             }
@@ -379,15 +403,16 @@ Schema* analyze_ast(Node* root) {
             else if (value->type == NODE_OBJECT) {
                 Table* table = malloc(sizeof(Table));
                 if (!table) continue;
-                table->name = strdup(pair->key);
+                table->name = pair->key;
                 table->next = schema->tables;
                 schema->tables = table;
                 schema->table_count++;
                 table->column_count = value->data.object.pair_count;
+                table->row_count = 0;
                 table->columns = malloc(sizeof(char*) * table->column_count);
-                for (int j = 0; j < value->data.object.pair_count; j++) {
+                for (size_t j = 0; j < value->data.object.pair_count; j++) {
                     Pair* field = value->data.object.pairs[j];
-                    table->columns[j] = strdup(field->key);
+                    table->columns[j] = field->key;
                 }
             }
         }
@@ -400,11 +425,7 @@ void free_schema(Schema* schema) {
     while (current) {
         Table* next = current->next;
         
-        for (int i = 0; i < current->column_count; i++) {
-            free(current->columns[i]);
-        }
         free(current->columns);
-        free(current->name);
         free(current);
         
         current = next;
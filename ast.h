@@ -1,6 +1,8 @@
 #ifndef AST_H
 #define AST_H
 
+#include <stddef.h>
+
 typedef enum {
     NODE_OBJECT,
     NODE_ARRAY,
@@ -10,38 +12,45 @@ typedef enum {
     NODE_NULL
 } NodeType;
 
+/* String value: a view into the input buffer, or an owned copy when the
+ * source contained escape sequences that had to be decoded */
+typedef struct {
+    const char* chars;  /* Not NUL-terminated when it points into the input */
+    size_t length;
+    int owned;          /* chars was malloc'd and is freed with the node */
+} JsonString;
+
 typedef struct Pair {
-    char* key;
+    const char* key;    /* Interned in the parse's SymbolTable */
     struct Node* value;
 } Pair;
 
 typedef struct Node {
     NodeType type;
-    int line;
-    int column;
+    size_t offset;  /* Byte offset of the value in the input */
     
     union {
         struct {
             Pair** pairs;
-            int pair_count;
+            size_t pair_count;
         } object;
         
         struct {
             struct Node** elements;
-            int element_count;
+            size_t element_count;
         } array;
         
-        char* string_value;
-        double number_value;
+        JsonString string;
+        JsonString number;  /* Lexeme as written in the input */
         int boolean_value;
     } data;
 } Node;
 
 /* Node creation functions */
-Node* create_object_node(Pair** pairs, int pair_count);
-Node* create_array_node(Node** elements, int element_count);
-Node* create_string_node(const char* value);
-Node* create_number_node(double value);
+Node* create_object_node(Pair** pairs, size_t pair_count);
+Node* create_array_node(Node** elements, size_t element_count);
+Node* create_string_node(JsonString value);
+Node* create_number_node(JsonString lexeme);
 Node* create_boolean_node(int value);
 Node* create_null_node();
 Pair* create_pair_node(const char* key, Node* value);
@@ -50,21 +59,27 @@ Pair* create_pair_node(const char* key, Node* value);
 void add_pair_to_object(Node* object, Pair* pair);
 void add_element_to_array(Node* array, Node* element);
 
+/* Numeric value of a number node, converted from its lexeme on demand */
+double get_number_value(const Node* node);
+
 /* AST operations */
 void print_ast(Node* node, int indent);
 void free_ast(Node* node);
+void free_pair(Pair* pair);
 
 /* Table structure definition */
+/* Table and column names are interned keys owned by the SymbolTable */
 typedef struct Table {
-    char* name;
-    char** columns;
-    int column_count;
+    const char* name;
+    const char** columns;
+    size_t column_count;
+    long long row_count; /* Rows written so far, counted against --limit */
     struct Table* next;
 } Table;
 
 typedef struct Schema {
     Table* tables;
-    int table_count;
+    size_t table_count;
 } Schema;
 
 /* AST analysis for CSV generation */
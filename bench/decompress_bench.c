@@ -0,0 +1,118 @@
+/* Benchmark: decompress_input() and the streaming Decompressor with 1 to
+ * N threads on a gzip file. Every output must be the same as the serial
+ * one, which is checked by hashing it. Only inputs whose members record
+ * their sizes (BGZF, as written by bgzip) are inflated on more than one
+ * thread; others show the serial rate throughout.
+ *
+ *   gcc -O2 -I.. -o decompress_bench decompress_bench.c ../decompress.c ../input.c -lpthread -lz
+ *   bgzip -c ../data1.json > data1.json.gz
+ *   ./decompress_bench data1.json.gz 8
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "decompress.h"
+#include "input.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t mix(uint64_t hash, const void* bytes, size_t length) {
+    const unsigned char* p = bytes;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* Read a Decompressor to the end, hashing what it hands over */
+static int stream_output(const InputBuffer* input, Compression compression, int threads,
+                         uint64_t* hash, size_t* length) {
+    Decompressor* decompressor = start_decompressor(input->data, input->length, compression,
+                                                    threads);
+    if (!decompressor) return -1;
+
+    const char* chunk;
+    long size;
+    *hash = 14695981039346656037ULL;
+    *length = 0;
+    while ((size = decompressor_next(decompressor, &chunk)) > 0) {
+        *hash = mix(*hash, chunk, (size_t)size);
+        *length += (size_t)size;
+    }
+    if (size < 0) fprintf(stderr, "Error: %s\n", decompressor_error(decompressor));
+    free_decompressor(decompressor);
+    return size < 0 ? -1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <file.gz> [max_threads]\n", argv[0]);
+        return 1;
+    }
+    int max_threads = argc == 3 ? atoi(argv[2]) : 8;
+
+    InputBuffer* input = open_input(argv[1]);
+    if (!input) {
+        fprintf(stderr, "Error: Could not open '%s'\n", argv[1]);
+        return 1;
+    }
+    Compression compression = detect_compression(input->data, input->length);
+    if (compression == COMPRESSION_NONE) {
+        fprintf(stderr, "Error: '%s' is not compressed\n", argv[1]);
+        return 1;
+    }
+
+    char error[256];
+    double start = now();
+    InputBuffer* output = decompress_input(input, compression, 1, error, sizeof(error));
+    double serial_time = now() - start;
+    if (!output) {
+        fprintf(stderr, "Error: %s\n", error);
+        return 1;
+    }
+    uint64_t expected = mix(14695981039346656037ULL, output->data, output->length);
+    double megabytes = output->length / 1e6;
+    close_input(output);
+    printf("%s, %.1f MB out\n", compression_name(compression), megabytes);
+    printf("in memory  threads   1  %8.1f MB/s\n", megabytes / serial_time);
+
+    int failed = 0;
+    for (int threads = 2; threads <= max_threads; threads *= 2) {
+        start = now();
+        output = decompress_input(input, compression, threads, error, sizeof(error));
+        double elapsed = now() - start;
+
+        if (!output || mix(14695981039346656037ULL, output->data, output->length) != expected) {
+            printf("in memory  threads %3d  MISMATCH\n", threads);
+            failed = 1;
+        } else {
+            printf("in memory  threads %3d  %8.1f MB/s  (%.2fx)\n", threads,
+                   megabytes / elapsed, serial_time / elapsed);
+        }
+        close_input(output);
+    }
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        uint64_t hash;
+        size_t length;
+        start = now();
+        int status = stream_output(input, compression, threads, &hash, &length);
+        double elapsed = now() - start;
+
+        if (status != 0 || hash != expected) {
+            printf("streamed   threads %3d  MISMATCH\n", threads);
+            failed = 1;
+        } else {
+            printf("streamed   threads %3d  %8.1f MB/s  (%.2fx)\n", threads,
+                   length / 1e6 / elapsed, serial_time / elapsed);
+        }
+    }
+
+    close_input(input);
+    return failed;
+}
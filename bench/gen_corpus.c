@@ -0,0 +1,75 @@
+/* Corpus generator for testing past 32-bit limits: writes a document with
+ * one "users" array of rows, or the same rows as NDJSON, to standard
+ * output. Each row is padded to about row_bytes, so a few tens of millions
+ * of rows pass 4 GB, and more than 2^31 rows checks that ids and row counts
+ * do not wrap. The sizes are reported on standard error.
+ *
+ *   gcc -O2 -o gen_corpus gen_corpus.c
+ *   ./gen_corpus 40000000 120 > /tmp/big.json          # about 4.8 GB
+ *   ./gen_corpus 2200000000 --ndjson > /tmp/rows.ndjson # over 2^31 rows
+ *   ../csv_parser /tmp/big.json --stream
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_ROW_BYTES 96
+
+static const char* countries[] = { "Canada", "Australia", "Japan", "Brazil", "Norway" };
+
+/* One row, padded with a note so that it is about row_bytes long */
+static size_t write_row(FILE* out, long long id, size_t row_bytes, const char* padding) {
+    int length = fprintf(out,
+        "{\"id\":%lld,\"name\":\"User %lld\",\"email\":\"user%lld@example.com\","
+        "\"age\":%lld,\"isActive\":%s,\"country\":\"%s\",\"note\":\"",
+        id, id, id, 18 + id % 60, id % 3 ? "true" : "false", countries[id % 5]);
+    if (length < 0) return 0;
+
+    size_t written = (size_t)length;
+    size_t pad = row_bytes > written + 2 ? row_bytes - written - 2 : 0;
+    fwrite(padding, 1, pad, out);
+    fputs("\"}", out);
+    return written + pad + 2;
+}
+
+int main(int argc, char** argv) {
+    long long rows = 0;
+    size_t row_bytes = MIN_ROW_BYTES;
+    int ndjson = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ndjson") == 0) {
+            ndjson = 1;
+        } else if (rows == 0) {
+            rows = strtoll(argv[i], NULL, 10);
+        } else {
+            row_bytes = strtoull(argv[i], NULL, 10);
+        }
+    }
+    if (rows <= 0) {
+        fprintf(stderr, "Usage: %s <rows> [row_bytes] [--ndjson]\n", argv[0]);
+        return 1;
+    }
+    if (row_bytes < MIN_ROW_BYTES) row_bytes = MIN_ROW_BYTES;
+
+    char* padding = malloc(row_bytes);
+    memset(padding, 'x', row_bytes);
+    setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+
+    size_t total = 0;
+    if (!ndjson) total += fprintf(stdout, "{\"users\":[\n");
+    for (long long id = 1; id <= rows; id++) {
+        total += write_row(stdout, id, row_bytes, padding);
+        if (!ndjson && id < rows) total += fprintf(stdout, ",");
+        total += fprintf(stdout, "\n");
+    }
+    if (!ndjson) total += fprintf(stdout, "]}\n");
+
+    free(padding);
+    if (fflush(stdout) != 0) {
+        fprintf(stderr, "Error: Could not write output\n");
+        return 1;
+    }
+    fprintf(stderr, "%lld rows, %zu bytes (%.2f GB)\n", rows, total, total / 1e9);
+    return 0;
+}
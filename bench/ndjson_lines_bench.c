@@ -0,0 +1,106 @@
+/* Benchmark: parse_json_lines() on NDJSON whose first line is padded by 0
+ * to 2 * RECORD_BYTES bytes, so the 1 MB chunk cuts land at every
+ * alignment around one record. Single-line records must always parse to
+ * the same count. A record split over two lines, and two records on one
+ * line, must always fail with the same message, whether a cut falls
+ * before, inside or after them, on 1 and N threads.
+ *
+ *   cd .. && bison -d parser.y && cd bench
+ *   gcc -O2 -I.. -o ndjson_lines_bench ndjson_lines_bench.c ../parallel_parse.c ../parser.tab.c \
+ *       ../lexer.c ../ast.c ../structural_index.c ../string_decoder.c ../number_parser.c \
+ *       ../symbol_table.c ../input.c -lpthread
+ *   ./ndjson_lines_bench 4
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "input.h"
+#include "parallel_parse.h"
+#include "parser.tab.h"
+
+#define CHUNK_BYTES (1 << 20)   /* LINE_CHUNK_SIZE in parallel_parse.c */
+#define RECORDS 150000
+#define RECORD_BYTES 24         /* {"a":000000,"b":000000} and a newline */
+
+enum { VALID, SPLIT, JOINED };
+static const char* layouts[] = { "valid", "split", "joined" };
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int count_records(void* user, Node* records, size_t end) {
+    (void)end;
+    *(size_t*)user += records->data.array.element_count;
+    return JSON_CONTINUE;
+}
+
+/* A padded document: a line of pad bytes, then RECORDS records with
+ * the one that starts nearest the first cut laid out as layout says */
+static char* build(size_t pad, int layout, size_t* length) {
+    char* data = malloc(RECORDS * (RECORD_BYTES + 1) + 2 * RECORD_BYTES + 32 + INPUT_PADDING);
+    size_t n = (size_t)sprintf(data, "{\"pad\":\"");
+    memset(data + n, 'x', pad);
+    n += pad;
+    n += (size_t)sprintf(data + n, "\"}\n");
+
+    size_t odd = (CHUNK_BYTES - 11) / RECORD_BYTES;   /* At the cut for pad 0 */
+    for (size_t i = 0; i < RECORDS; i++) {
+        const char* format = "{\"a\":%06zu,\"b\":%06zu}\n";
+        if (i == odd && layout == SPLIT) format = "{\"a\":%06zu,\n\"b\":%06zu}\n";
+        if (i == odd && layout == JOINED) format = "{\"a\":%06zu,\"b\":%06zu} ";
+        n += (size_t)sprintf(data + n, format, i, i);
+    }
+    memset(data + n, 0, INPUT_PADDING);
+    *length = n;
+    return data;
+}
+
+int main(int argc, char** argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 4;
+    if (max_threads < 2) max_threads = 2;
+
+    int failed = 0;
+    for (int layout = VALID; layout <= JOINED; layout++) {
+        char expected[256] = "";
+        int first = 1;
+        double bytes = 0, elapsed = 0;
+
+        for (size_t pad = 0; pad <= 2 * RECORD_BYTES; pad++) {
+            size_t length;
+            char* data = build(pad, layout, &length);
+
+            for (int threads = 1; threads <= max_threads; threads += max_threads - 1) {
+                char error[256] = "";
+                size_t count = 0;
+                SymbolTable* symbols = create_symbol_table();
+                double start = now();
+                int result = parse_json_lines(data, 0, length, symbols, threads, count_records,
+                                              &count, error, sizeof(error));
+                elapsed += now() - start;
+                bytes += length;
+                free_symbol_table(symbols);
+
+                if (layout == VALID ? result != 0 || count != RECORDS + 1 : result == 0) {
+                    printf("%-6s pad %2zu threads %d  %s (%zu records)\n", layouts[layout],
+                           pad, threads, result == 0 ? "ACCEPTED" : error, count);
+                    failed = 1;
+                } else if (first) {
+                    strcpy(expected, error);
+                    first = 0;
+                } else if (strcmp(error, expected) != 0) {
+                    printf("%-6s pad %2zu threads %d  MISMATCH: %s\n", layouts[layout], pad,
+                           threads, error);
+                    failed = 1;
+                }
+            }
+            free(data);
+        }
+        printf("%-6s %8.1f MB/s  %s\n", layouts[layout], bytes / 1e6 / elapsed,
+               layout == VALID ? "all records" : expected);
+    }
+    return failed;
+}
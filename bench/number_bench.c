@@ -0,0 +1,121 @@
+/* Microbenchmark: parse_number() against atof() on the numeric values of
+ * the sample data files.
+ *
+ *   gcc -O2 -I.. -o number_bench number_bench.c ../number_parser.c
+ *   ./number_bench ../data1.json ../data2.json ../data3.json ../data4.json ../data5.json
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "number_parser.h"
+
+#define ROUNDS 20000
+
+typedef struct {
+    char* text;      /* NUL-terminated copy, for atof */
+    size_t length;
+} Lexeme;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Collect every number that appears as a value (after ':' or in an array) */
+static size_t collect_numbers(const char* path, Lexeme** lexemes, size_t count, size_t* capacity) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open '%s'\n", path);
+        return count;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = malloc(size + 1);
+    size_t read = fread(data, 1, size, file);
+    data[read] = '\0';
+    fclose(file);
+
+    char prev = 0;
+    int in_string = 0;
+    for (size_t i = 0; i < read; i++) {
+        char c = data[i];
+        if (in_string) {
+            if (c == '\\') i++;
+            else if (c == '"') in_string = 0;
+            continue;
+        }
+        if (c == '"') {
+            in_string = 1;
+        } else if (c >= '0' && c <= '9' && (prev == ':' || prev == '[' || prev == ',')) {
+            size_t start = i;
+            while (i < read && strchr("0123456789.eE+-", data[i])) i++;
+            if (count == *capacity) {
+                *capacity = *capacity ? *capacity * 2 : 256;
+                *lexemes = realloc(*lexemes, *capacity * sizeof(Lexeme));
+            }
+            (*lexemes)[count].length = i - start;
+            (*lexemes)[count].text = strndup(data + start, i - start);
+            count++;
+            c = data[i];
+        }
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') prev = c;
+    }
+
+    free(data);
+    return count;
+}
+
+int main(int argc, char** argv) {
+    Lexeme* lexemes = NULL;
+    size_t count = 0, capacity = 0;
+
+    for (int i = 1; i < argc; i++) {
+        count = collect_numbers(argv[i], &lexemes, count, &capacity);
+    }
+    if (count == 0) {
+        fprintf(stderr, "Usage: %s <file.json>...\n", argv[0]);
+        return 1;
+    }
+
+    /* Both must agree bit for bit before timing means anything */
+    for (size_t i = 0; i < count; i++) {
+        double fast = parse_number(lexemes[i].text, lexemes[i].length);
+        double slow = atof(lexemes[i].text);
+        if (memcmp(&fast, &slow, sizeof(double)) != 0) {
+            fprintf(stderr, "Mismatch on %s: %.17g vs %.17g\n", lexemes[i].text, fast, slow);
+            return 1;
+        }
+    }
+
+    volatile double sink = 0;
+    double start = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < count; i++) {
+            sink += atof(lexemes[i].text);
+        }
+    }
+    double atof_time = now() - start;
+
+    start = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < count; i++) {
+            sink += parse_number(lexemes[i].text, lexemes[i].length);
+        }
+    }
+    double fast_time = now() - start;
+
+    double calls = (double)count * ROUNDS;
+    printf("%zu numbers x %d rounds\n", count, ROUNDS);
+    printf("atof:         %6.2f ns/number\n", atof_time / calls * 1e9);
+    printf("parse_number: %6.2f ns/number (%.1fx)\n", fast_time / calls * 1e9, atof_time / fast_time);
+
+    for (size_t i = 0; i < count; i++) {
+        free(lexemes[i].text);
+    }
+    free(lexemes);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/* Benchmark: parse_json_parallel() with 1 to N threads against
+ * parse_json(). Every tree must be the same as the serial one, which is
+ * checked by hashing its nodes in order.
+ *
+ *   cd .. && bison -d parser.y && cd bench
+ *   gcc -O2 -I.. -o parallel_bench parallel_bench.c ../parallel_parse.c ../parser.tab.c \
+ *       ../lexer.c ../ast.c ../structural_index.c ../string_decoder.c ../number_parser.c \
+ *       ../symbol_table.c ../input.c -lpthread
+ *   ./parallel_bench ../data1.json 8
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "input.h"
+#include "parallel_parse.h"
+#include "parser.tab.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t mix(uint64_t hash, const void* bytes, size_t length) {
+    const unsigned char* p = bytes;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t hash_tree(uint64_t hash, const Node* node) {
+    hash = mix(hash, &node->type, sizeof(node->type));
+    hash = mix(hash, &node->offset, sizeof(node->offset));
+    switch (node->type) {
+        case NODE_OBJECT:
+            for (size_t i = 0; i < node->data.object.pair_count; i++) {
+                const Pair* pair = node->data.object.pairs[i];
+                hash = mix(hash, pair->key, strlen(pair->key));
+                hash = hash_tree(hash, pair->value);
+            }
+            break;
+        case NODE_ARRAY:
+            for (size_t i = 0; i < node->data.array.element_count; i++) {
+                hash = hash_tree(hash, node->data.array.elements[i]);
+            }
+            break;
+        case NODE_STRING:
+            hash = mix(hash, node->data.string.chars, node->data.string.length);
+            break;
+        case NODE_NUMBER:
+            hash = mix(hash, node->data.number.chars, node->data.number.length);
+            break;
+        case NODE_BOOLEAN:
+            hash = mix(hash, &node->data.boolean_value, sizeof(int));
+            break;
+        default:
+            break;
+    }
+    return hash;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <file.json> [max_threads]\n", argv[0]);
+        return 1;
+    }
+    int max_threads = argc == 3 ? atoi(argv[2]) : 8;
+
+    InputBuffer* input = open_input(argv[1]);
+    if (!input) {
+        fprintf(stderr, "Error: Could not open '%s'\n", argv[1]);
+        return 1;
+    }
+
+    char error[256];
+    double megabytes = input->length / 1e6;
+    SymbolTable* symbols = create_symbol_table();
+    double start = now();
+    Node* root = parse_json(input->data, input->length, symbols, error, sizeof(error));
+    double serial_time = now() - start;
+    if (!root) {
+        fprintf(stderr, "Error: %s\n", error);
+        return 1;
+    }
+    uint64_t expected = hash_tree(14695981039346656037ULL, root);
+    free_ast(root);
+    free_symbol_table(symbols);
+    printf("parse_json    %8.1f MB/s\n", megabytes / serial_time);
+
+    int failed = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        symbols = create_symbol_table();
+        start = now();
+        root = parse_json_parallel(input->data, input->length, symbols, threads,
+                                   error, sizeof(error));
+        double elapsed = now() - start;
+
+        if (!root || hash_tree(14695981039346656037ULL, root) != expected) {
+            printf("threads %3d  MISMATCH\n", threads);
+            failed = 1;
+        } else {
+            printf("threads %3d  %8.1f MB/s  (%.2fx)\n", threads, megabytes / elapsed,
+                   serial_time / elapsed);
+        }
+        free_ast(root);
+        free_symbol_table(symbols);
+    }
+
+    close_input(input);
+    return failed;
+}
@@ -0,0 +1,101 @@
+/* Benchmark: parse_json_projected() against parse_json(). Both trees
+ * must give the same schema from analyze_ast(); the node counts show how
+ * much of the document the projection left out.
+ *
+ *   cd .. && bison -d parser.y && cd bench
+ *   gcc -O2 -I.. -o projection_bench projection_bench.c ../projection.c ../csv_generator.c ../parser.tab.c \
+ *       ../lexer.c ../ast.c ../structural_index.c ../string_decoder.c ../number_parser.c \
+ *       ../symbol_table.c ../input.c -lpthread
+ *   ./projection_bench ../data1.json
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "input.h"
+#include "parser.tab.h"
+#include "projection.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t count_nodes(const Node* node) {
+    size_t count = 1;
+    if (node->type == NODE_OBJECT) {
+        for (size_t i = 0; i < node->data.object.pair_count; i++) {
+            count += count_nodes(node->data.object.pairs[i]->value);
+        }
+    } else if (node->type == NODE_ARRAY) {
+        for (size_t i = 0; i < node->data.array.element_count; i++) {
+            count += count_nodes(node->data.array.elements[i]);
+        }
+    }
+    return count;
+}
+
+/* Keys are interned in one table, so they compare by pointer */
+static int same_schema(const Schema* a, const Schema* b) {
+    if (a->table_count != b->table_count) return 0;
+    for (const Table *x = a->tables, *y = b->tables; x && y; x = x->next, y = y->next) {
+        if (x->name != y->name || x->column_count != y->column_count) return 0;
+        for (size_t i = 0; i < x->column_count; i++) {
+            if (x->columns[i] != y->columns[i]) return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <file.json>\n", argv[0]);
+        return 1;
+    }
+
+    InputBuffer* input = open_input(argv[1]);
+    if (!input) {
+        fprintf(stderr, "Error: Could not open '%s'\n", argv[1]);
+        return 1;
+    }
+
+    char error[256];
+    double megabytes = input->length / 1e6;
+    SymbolTable* symbols = create_symbol_table();
+
+    double start = now();
+    Node* full = parse_json(input->data, input->length, symbols, error, sizeof(error));
+    double full_time = now() - start;
+    if (!full) {
+        fprintf(stderr, "Error: %s\n", error);
+        return 1;
+    }
+
+    start = now();
+    Node* projected = parse_json_projected(input->data, input->length, symbols, NULL, NULL,
+                                           error, sizeof(error));
+    double projected_time = now() - start;
+    if (!projected) {
+        fprintf(stderr, "Error: %s\n", error);
+        return 1;
+    }
+
+    Schema* expected = analyze_ast(full);
+    Schema* schema = analyze_ast(projected);
+    int failed = !same_schema(expected, schema);
+
+    printf("parse_json            %8.1f MB/s  %10zu nodes\n", megabytes / full_time,
+           count_nodes(full));
+    printf("parse_json_projected  %8.1f MB/s  %10zu nodes  (%.2fx)%s\n",
+           megabytes / projected_time, count_nodes(projected), full_time / projected_time,
+           failed ? "  SCHEMA MISMATCH" : "");
+
+    free_schema(expected);
+    free_schema(schema);
+    free_ast(full);
+    free_ast(projected);
+    free_symbol_table(symbols);
+    close_input(input);
+    return failed;
+}
@@ -0,0 +1,109 @@
+/* Benchmark: the push parser fed in chunks of various sizes, against
+ * parse_json_events() on the whole buffer. Every run must produce the
+ * same events, so splitting tokens, strings and UTF-8 sequences across
+ * chunks is checked along the way.
+ *
+ *   cd .. && bison -d parser.y && cd bench
+ *   gcc -O2 -I.. -o push_bench push_bench.c ../parser.tab.c ../lexer.c ../ast.c \
+ *       ../structural_index.c ../string_decoder.c ../number_parser.c ../symbol_table.c ../input.c
+ *   ./push_bench ../data1.json
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "input.h"
+#include "parser.tab.h"
+
+typedef struct {
+    uint64_t hash;
+    size_t events;
+} EventDigest;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void mix(EventDigest* digest, const void* bytes, size_t length) {
+    const unsigned char* p = bytes;
+    for (size_t i = 0; i < length; i++) {
+        digest->hash = (digest->hash ^ p[i]) * 1099511628211ULL;
+    }
+    digest->events++;
+}
+
+static int on_start_object(void* user, size_t offset) { mix(user, "{", 1); mix(user, &offset, sizeof(offset)); return JSON_CONTINUE; }
+static int on_end_object(void* user) { mix(user, "}", 1); return JSON_CONTINUE; }
+static int on_start_array(void* user, size_t offset) { mix(user, "[", 1); mix(user, &offset, sizeof(offset)); return JSON_CONTINUE; }
+static int on_end_array(void* user) { mix(user, "]", 1); return JSON_CONTINUE; }
+static int on_key(void* user, const char* key) { mix(user, key, strlen(key)); return JSON_CONTINUE; }
+
+static int on_scalar(void* user, Node* value) {
+    mix(user, &value->type, sizeof(value->type));
+    mix(user, &value->offset, sizeof(value->offset));
+    if (value->type == NODE_STRING) mix(user, value->data.string.chars, value->data.string.length);
+    if (value->type == NODE_NUMBER) mix(user, value->data.number.chars, value->data.number.length);
+    if (value->type == NODE_BOOLEAN) mix(user, &value->data.boolean_value, sizeof(int));
+    return JSON_CONTINUE;
+}
+
+static const JsonHandler digest_handler = {
+    on_start_object, on_end_object, on_start_array, on_end_array, on_key, on_scalar
+};
+
+int main(int argc, char** argv) {
+    static const size_t chunk_sizes[] = { 1, 7, 64, 1000, 4096, 65536, 1 << 20 };
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <file.json>\n", argv[0]);
+        return 1;
+    }
+    InputBuffer* input = open_input(argv[1]);
+    if (!input) {
+        fprintf(stderr, "Error: Could not open '%s'\n", argv[1]);
+        return 1;
+    }
+
+    char error[256];
+    SymbolTable* symbols = create_symbol_table();
+    EventDigest expected = { 14695981039346656037ULL, 0 };
+    double start = now();
+    if (parse_json_events(input->data, input->length, symbols, &digest_handler, &expected,
+                          error, sizeof(error)) != 0) {
+        fprintf(stderr, "Error: %s\n", error);
+        return 1;
+    }
+    double whole_time = now() - start;
+    double megabytes = input->length / 1e6;
+    printf("whole buffer  %8.1f MB/s  (%zu events)\n", megabytes / whole_time, expected.events);
+
+    int failed = 0;
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+        EventDigest digest = { 14695981039346656037ULL, 0 };
+        JsonPushParser* parser = create_push_parser(symbols, &digest_handler, &digest);
+
+        start = now();
+        int status = 0;
+        for (size_t offset = 0; offset < input->length && status == 0; offset += chunk_sizes[c]) {
+            size_t length = input->length - offset < chunk_sizes[c] ? input->length - offset : chunk_sizes[c];
+            status = push_parser_feed(parser, input->data + offset, length);
+        }
+        if (status == 0) status = push_parser_finish(parser);
+        double elapsed = now() - start;
+
+        if (status != 0 || digest.hash != expected.hash || digest.events != expected.events) {
+            printf("chunk %7zu  MISMATCH%s%s\n", chunk_sizes[c],
+                   status ? ": " : "", status ? push_parser_error(parser) : "");
+            failed = 1;
+        } else {
+            printf("chunk %7zu  %8.1f MB/s\n", chunk_sizes[c], megabytes / elapsed);
+        }
+        free_push_parser(parser);
+    }
+
+    free_symbol_table(symbols);
+    close_input(input);
+    return failed;
+}
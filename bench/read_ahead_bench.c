@@ -0,0 +1,109 @@
+/* Benchmark: reading a file block by block with blocking pread() calls
+ * against open_read_ahead(), with the same amount of work done on each
+ * block between reads, as a parser would. The file's pages are dropped
+ * from the page cache before each run (posix_fadvise), so reads go to the
+ * disk. Stall is the time spent waiting for data rather than working; the
+ * read-ahead runs should hide most of it. Every run must see the same
+ * bytes.
+ *
+ *   gcc -O2 -I.. -o read_ahead_bench read_ahead_bench.c ../read_ahead.c -lpthread
+ *   ./read_ahead_bench ../data1.json 1024 8
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "read_ahead.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Stand-in for parsing: a byte-at-a-time hash, a few hundred MB/s */
+static uint64_t work(uint64_t hash, const char* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void drop_cache(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static uint64_t blocking_run(const char* path, size_t block_size, double* stall) {
+    int fd = open(path, O_RDONLY);
+    char* buffer = malloc(block_size);
+    uint64_t hash = 14695981039346656037ULL;
+    *stall = 0;
+    for (off_t offset = 0;; ) {
+        double start = now();
+        ssize_t n = pread(fd, buffer, block_size, offset);
+        *stall += now() - start;
+        if (n <= 0) break;
+        hash = work(hash, buffer, (size_t)n);
+        offset += n;
+    }
+    free(buffer);
+    close(fd);
+    return hash;
+}
+
+static uint64_t read_ahead_run(const char* path, size_t block_size, int depth, double* stall,
+                               const char** backend) {
+    ReadAhead* reader = open_read_ahead(path, block_size, depth);
+    uint64_t hash = 14695981039346656037ULL;
+    const char* block;
+    *stall = 0;
+    for (;;) {
+        double start = now();
+        long n = read_ahead_next(reader, &block);
+        *stall += now() - start;
+        if (n <= 0) break;
+        hash = work(hash, block, (size_t)n);
+    }
+    *backend = read_ahead_backend(reader);
+    close_read_ahead(reader);
+    return hash;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "Usage: %s <file> [block_kb] [max_depth]\n", argv[0]);
+        return 1;
+    }
+    size_t block_size = (argc >= 3 ? (size_t)atoi(argv[2]) : 1024) << 10;
+    int max_depth = argc == 4 ? atoi(argv[3]) : 8;
+
+    double stall;
+    drop_cache(argv[1]);
+    double start = now();
+    uint64_t expected = blocking_run(argv[1], block_size, &stall);
+    double total = now() - start;
+    printf("blocking pread      %7.3f s  stall %7.3f s\n", total, stall);
+
+    int failed = 0;
+    for (int depth = 1; depth <= max_depth; depth *= 2) {
+        const char* backend;
+        drop_cache(argv[1]);
+        start = now();
+        uint64_t hash = read_ahead_run(argv[1], block_size, depth, &stall, &backend);
+        double elapsed = now() - start;
+        if (hash != expected) {
+            printf("%-8s depth %3d  MISMATCH\n", backend, depth);
+            failed = 1;
+        } else {
+            printf("%-8s depth %3d  %7.3f s  stall %7.3f s\n", backend, depth, elapsed, stall);
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,94 @@
+/* Benchmark: loading a file by path (memory-mapped) against reading the
+ * same bytes from a pipe, as `cat file | csv_parser -` does, with read
+ * sizes from 16 KB to 4 MB. A child process writes the file into the pipe.
+ * Every buffer must hold the same bytes as the file.
+ *
+ *   gcc -O2 -I.. -o read_bench read_bench.c ../input.c
+ *   ./read_bench ../data1.json
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "input.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Read data through a pipe on standard input, read_size bytes at a time.
+ * Returns the seconds taken, or a negative number if the bytes differ. */
+static double read_pipe(const char* data, size_t length, size_t read_size) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+
+    pid_t writer = fork();
+    if (writer == 0) {
+        close(fds[0]);
+        for (size_t offset = 0; offset < length; ) {
+            ssize_t n = write(fds[1], data + offset, length - offset);
+            if (n <= 0) _exit(1);
+            offset += (size_t)n;
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+
+    int saved = dup(STDIN_FILENO);
+    dup2(fds[0], STDIN_FILENO);
+    close(fds[0]);
+
+    double start = now();
+    InputBuffer* input = open_input_read_size("-", read_size);
+    double elapsed = now() - start;
+
+    dup2(saved, STDIN_FILENO);
+    close(saved);
+    waitpid(writer, NULL, 0);
+
+    int same = input && input->length == length && memcmp(input->data, data, length) == 0;
+    close_input(input);
+    return same ? elapsed : -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <file.json>\n", argv[0]);
+        return 1;
+    }
+
+    double start = now();
+    InputBuffer* file = open_input(argv[1]);
+    double mapped_time = now() - start;
+    if (!file) {
+        fprintf(stderr, "Error: Could not open '%s'\n", argv[1]);
+        return 1;
+    }
+
+    /* Touch every page, as the parser will, so the mapping is not free */
+    start = now();
+    volatile unsigned long sum = 0;
+    for (size_t i = 0; i < file->length; i += 4096) sum += (unsigned char)file->data[i];
+    mapped_time += now() - start;
+
+    double megabytes = file->length / 1e6;
+    printf("path (mmap)          %8.1f MB/s\n", megabytes / mapped_time);
+
+    int failed = 0;
+    for (size_t read_size = 16 << 10; read_size <= 4 << 20; read_size *= 4) {
+        double elapsed = read_pipe(file->data, file->length, read_size);
+        if (elapsed < 0) {
+            printf("pipe, %4zu KB reads  MISMATCH\n", read_size >> 10);
+            failed = 1;
+        } else {
+            printf("pipe, %4zu KB reads  %8.1f MB/s\n", read_size >> 10, megabytes / elapsed);
+        }
+    }
+
+    close_input(file);
+    return failed;
+}
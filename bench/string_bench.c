@@ -0,0 +1,175 @@
+/* Benchmark: string scanning, UTF-8 validation and escape decoding on
+ * ASCII, escape-heavy and non-ASCII corpora, against byte-at-a-time
+ * versions of the same work.
+ *
+ *   gcc -O2 -I.. -o string_bench string_bench.c ../string_decoder.c
+ *   ./string_bench
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "string_decoder.h"
+
+#define STRING_COUNT 20000
+#define ROUNDS 50
+
+typedef struct {
+    const char* name;
+    const char* pieces[8];  /* Fragments strings are assembled from */
+} Corpus;
+
+static const Corpus corpora[] = {
+    { "ascii",   { "alice.j@example.com", "Exploring the Mountains ", "2024-11-01T10:00:00Z", NULL } },
+    { "escapes", { "line\\nbreak ", "\\\"quoted\\\" ", "caf\\u00e9 ", "\\ud83d\\ude00 ", "tab\\t", NULL } },
+    { "utf8",    { "Ünïcödé ", "日本語のテキスト ", "Привет мир ", "😀🎉 ", "naïve café ", NULL } },
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Byte-at-a-time closing quote search */
+static const char* scan_scalar(const char* p, const char* limit, int* flags) {
+    *flags = 0;
+    while (p < limit) {
+        if (*p == '"') return p;
+        if (*p == '\\') {
+            *flags |= STRING_HAS_ESCAPES;
+            p += 2;
+            continue;
+        }
+        if ((unsigned char)*p >= 0x80) *flags |= STRING_HAS_NON_ASCII;
+        p++;
+    }
+    return NULL;
+}
+
+/* Byte-at-a-time UTF-8 check, decoding each code point */
+static int validate_scalar(const unsigned char* s, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        unsigned c = s[i];
+        int extra;
+        unsigned long cp;
+        if (c < 0x80) { i++; continue; }
+        if ((c & 0xE0) == 0xC0) { extra = 1; cp = c & 0x1F; }
+        else if ((c & 0xF0) == 0xE0) { extra = 2; cp = c & 0x0F; }
+        else if ((c & 0xF8) == 0xF0) { extra = 3; cp = c & 0x07; }
+        else return 0;
+        if (i + extra >= len) return 0;
+        for (int j = 1; j <= extra; j++) {
+            if ((s[i + j] & 0xC0) != 0x80) return 0;
+            cp = cp << 6 | (s[i + j] & 0x3F);
+        }
+        if ((extra == 1 && cp < 0x80) || (extra == 2 && cp < 0x800) ||
+            (extra == 3 && cp < 0x10000) || cp > 0x10FFFF ||
+            (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+        i += extra + 1;
+    }
+    return 1;
+}
+
+/* Byte-at-a-time escape decoding */
+static long decode_scalar(const char* p, size_t len, char* out) {
+    const char* end = p + len;
+    char* o = out;
+    while (p < end) {
+        if (*p != '\\') {
+            *o++ = *p++;
+            continue;
+        }
+        p++;
+        char c = *p++;
+        if (c == 'u') {
+            unsigned long cp = strtoul((char[]){ p[0], p[1], p[2], p[3], 0 }, NULL, 16);
+            p += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                unsigned long low = strtoul((char[]){ p[2], p[3], p[4], p[5], 0 }, NULL, 16);
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                p += 6;
+            }
+            if (cp < 0x80) *o++ = (char)cp;
+            else if (cp < 0x800) { *o++ = (char)(0xC0 | cp >> 6); *o++ = (char)(0x80 | (cp & 0x3F)); }
+            else if (cp < 0x10000) { *o++ = (char)(0xE0 | cp >> 12); *o++ = (char)(0x80 | (cp >> 6 & 0x3F)); *o++ = (char)(0x80 | (cp & 0x3F)); }
+            else { *o++ = (char)(0xF0 | cp >> 18); *o++ = (char)(0x80 | (cp >> 12 & 0x3F)); *o++ = (char)(0x80 | (cp >> 6 & 0x3F)); *o++ = (char)(0x80 | (cp & 0x3F)); }
+        } else {
+            *o++ = c == 'n' ? '\n' : c == 't' ? '\t' : c;
+        }
+    }
+    *o = '\0';
+    return validate_scalar((const unsigned char*)out, o - out) ? o - out : -1;
+}
+
+int main(void) {
+    for (size_t c = 0; c < sizeof(corpora) / sizeof(corpora[0]); c++) {
+        const Corpus* corpus = &corpora[c];
+
+        /* Build quoted strings back to back, like they sit in a document */
+        size_t capacity = 1 << 20, length = 0;
+        char* data = malloc(capacity);
+        size_t starts[STRING_COUNT];
+        int piece_count = 0;
+        while (corpus->pieces[piece_count]) piece_count++;
+
+        for (int i = 0; i < STRING_COUNT; i++) {
+            if (length + 256 > capacity) {
+                capacity *= 2;
+                data = realloc(data, capacity);
+            }
+            data[length++] = '"';
+            starts[i] = length;
+            for (int k = 0; k < 1 + i % 4; k++) {
+                const char* piece = corpus->pieces[(i + k) % piece_count];
+                memcpy(data + length, piece, strlen(piece));
+                length += strlen(piece);
+            }
+            data[length++] = '"';
+            data[length++] = ',';
+        }
+        data = realloc(data, length + 64);
+        memset(data + length, 0, 64);
+        char* out = malloc(length + 64);
+
+        double scalar_time = 0, simd_time = 0;
+        long checksum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            double start = now();
+            for (int i = 0; i < STRING_COUNT; i++) {
+                int flags;
+                const char* s = data + starts[i];
+                const char* q = scan_scalar(s, data + length, &flags);
+                if (flags & STRING_HAS_ESCAPES) {
+                    checksum += decode_scalar(s, q - s, out);
+                } else if (flags & STRING_HAS_NON_ASCII) {
+                    checksum += validate_scalar((const unsigned char*)s, q - s);
+                }
+            }
+            scalar_time += now() - start;
+
+            start = now();
+            for (int i = 0; i < STRING_COUNT; i++) {
+                int flags;
+                const char* s = data + starts[i];
+                const char* q = scan_string_body(s, data + length, &flags);
+                if (flags & STRING_HAS_ESCAPES) {
+                    checksum += decode_json_string(s, q - s, out);
+                } else if (flags & STRING_HAS_NON_ASCII) {
+                    checksum += validate_utf8(s, q - s);
+                }
+            }
+            simd_time += now() - start;
+        }
+
+        double megabytes = (double)length * ROUNDS / 1e6;
+        printf("%-8s %7.1f KB  scalar %7.1f MB/s  simd %7.1f MB/s  (%ld)\n",
+               corpus->name, length / 1024.0, megabytes / scalar_time,
+               megabytes / simd_time, checksum);
+
+        free(out);
+        free(data);
+    }
+    return 0;
+}
@@ -3,8 +3,19 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <unistd.h>
 #include "csv_generator.h"
 
+struct OutputFile {
+    const char* name;
+    const char** columns;   /* Of the header written */
+    size_t column_count;
+    FILE* file;
+    long document_start;    /* Size before the current document's rows */
+    int skipped;            /* A table with other columns was skipped */
+    struct OutputFile* next;
+};
+
 /* Helper function to create directory if it doesn't exist */
 static int ensure_directory_exists(const char* dir) {
     struct stat st = {0};
@@ -28,55 +39,37 @@ static int ensure_directory_exists(const char* dir) {
     return 1;
 }
 
-/* CSV escaping function */
-static char* escape_csv_field(const char* str) {
-    if (str == NULL) return strdup("");
-    
-    /* Count characters that need escaping */
-    int len = strlen(str);
-    int escape_count = 0;
+/* Write a field, quoting it if it contains a comma, newline or quote */
+static void write_csv_field(FILE* file, const char* str, size_t len) {
     int needs_quotes = 0;
-    
-    for (int i = 0; i < len; i++) {
-        if (str[i] == '"') {
-            escape_count++;
-        }
+
+    for (size_t i = 0; i < len; i++) {
         if (str[i] == ',' || str[i] == '\n' || str[i] == '"') {
             needs_quotes = 1;
+            break;
         }
     }
-    
-    /* If no escaping or quoting needed, return a simple duplicate */
-    if (escape_count == 0 && !needs_quotes) {
-        return strdup(str);
-    }
-    
-    /* Allocate memory for escaped string */
-    char* escaped = malloc(len + escape_count + (needs_quotes ? 2 : 0) + 1);
-    int pos = 0;
-    
-    /* Add opening quote if needed */
-    if (needs_quotes) {
-        escaped[pos++] = '"';
+
+    /* If no escaping or quoting needed, copy the bytes as they are */
+    if (!needs_quotes) {
+        fwrite(str, 1, len, file);
+        return;
     }
-    
+
+    putc('"', file);
+
     /* Copy and escape string */
-    for (int i = 0; i < len; i++) {
+    size_t run = 0;
+    for (size_t i = 0; i < len; i++) {
         if (str[i] == '"') {
-            escaped[pos++] = '"';  /* Double quotes */
-            escaped[pos++] = '"';
-        } else {
-            escaped[pos++] = str[i];
+            fwrite(str + run, 1, i + 1 - run, file);
+            putc('"', file);  /* Double quotes */
+            run = i + 1;
         }
     }
-    
-    /* Add closing quote if needed */
-    if (needs_quotes) {
-        escaped[pos++] = '"';
-    }
-    
-    escaped[pos] = '\0';
-    return escaped;
+    fwrite(str + run, 1, len - run, file);
+
+    putc('"', file);
 }
 
 /* Initialize CSV generation context */
@@ -97,37 +90,121 @@ CSVContext* init_csv_context(const char* output_dir) {
     }
     
     context->next_id = 1;
+    context->format_numbers = 0;
+    context->limits = NULL;
+    context->keep_files_open = 0;
+    context->open_files = NULL;
     return context;
 }
 
 /* Free CSV context */
 void free_csv_context(CSVContext* context) {
     if (context) {
+        OutputFile* output = context->open_files;
+        while (output) {
+            OutputFile* next = output->next;
+            fclose(output->file);
+            free(output->columns);
+            free(output);
+            output = next;
+        }
         free(context->output_dir);
         free(context);
     }
 }
 
+/* Parse a limit, spec[0, length), into value */
+static int parse_limit(const char* spec, size_t length, long long* value) {
+    char digits[32];
+    char* end;
+
+    if (length == 0 || length >= sizeof(digits) || spec[0] < '0' || spec[0] > '9') return -1;
+    memcpy(digits, spec, length);
+    digits[length] = '\0';
+    *value = strtoll(digits, &end, 10);
+    return *end == '\0' && *value >= 0 ? 0 : -1;
+}
+
+RowLimits* parse_row_limits(const char* spec, char* error, size_t error_size) {
+    RowLimits* limits = calloc(1, sizeof(RowLimits));
+    limits->default_limit = -1;
+
+    for (const char* start = spec;; ) {
+        const char* end = strchr(start, ',');
+        size_t length = end ? (size_t)(end - start) : strlen(start);
+        const char* equals = memchr(start, '=', length);
+        int status;
+
+        if (!equals) {
+            status = parse_limit(start, length, &limits->default_limit);
+        } else {
+            limits->tables = realloc(limits->tables, (limits->count + 1) * sizeof(char*));
+            limits->limits = realloc(limits->limits, (limits->count + 1) * sizeof(long long));
+            limits->tables[limits->count] = strndup(start, equals - start);
+            status = equals == start ? -1
+                : parse_limit(equals + 1, length - (equals + 1 - start), &limits->limits[limits->count]);
+            limits->count++;
+        }
+        if (status != 0) {
+            snprintf(error, error_size, "invalid row limit '%.*s'", (int)length, start);
+            free_row_limits(limits);
+            return NULL;
+        }
+
+        if (!end) break;
+        start = end + 1;
+    }
+    return limits;
+}
+
+long long row_limit(const RowLimits* limits, const char* table) {
+    if (!limits) return -1;
+
+    for (int i = 0; i < limits->count; i++) {
+        if (strcmp(limits->tables[i], table) == 0) return limits->limits[i];
+    }
+    return limits->default_limit;
+}
+
+void free_row_limits(RowLimits* limits) {
+    if (!limits) return;
+
+    for (int i = 0; i < limits->count; i++) {
+        free(limits->tables[i]);
+    }
+    free(limits->tables);
+    free(limits->limits);
+    free(limits);
+}
+
+/* Whether --limit lets another row be written to table */
+static int below_limit(const Table* table, const CSVContext* context) {
+    long long limit = row_limit(context->limits, table->name);
+    return limit < 0 || table->row_count < limit;
+}
+
 /* Helper to write a node value to a CSV field */
-static void write_node_value(FILE* file, Node* node) {
+void write_node_value(FILE* file, const Node* node, CSVContext* context) {
     if (!node) {
         fprintf(file, "");
         return;
     }
     
-    char* escaped = NULL;
     char buffer[64]; /* For number conversion */
     
     switch (node->type) {
         case NODE_STRING:
-            escaped = escape_csv_field(node->data.string_value);
-            fprintf(file, "%s", escaped);
-            free(escaped);
+            write_csv_field(file, node->data.string.chars, node->data.string.length);
             break;
             
         case NODE_NUMBER:
-            snprintf(buffer, sizeof(buffer), "%g", node->data.number_value);
-            fprintf(file, "%s", buffer);
+            if (context->format_numbers) {
+                snprintf(buffer, sizeof(buffer), "%g", get_number_value(node));
+                fprintf(file, "%s", buffer);
+            } else {
+                /* Copy the digits exactly as they appeared in the input */
+                fwrite(node->data.number.chars, 1, node->data.number.length, file);
+            }
             break;
             
         case NODE_BOOLEAN:
@@ -147,10 +224,13 @@ static void write_node_value(FILE* file, Node* node) {
 }
 
 /* Writing CSV header row (column names) */
-static void write_csv_header(FILE* file, Table* table) {
-    fprintf(file, "%s", table->columns[0]); /* First column (ID) */
+void write_csv_header(FILE* file, Table* table) {
+    /* A table whose first row has no keys has no columns at all */
+    if (table->column_count > 0) {
+        fprintf(file, "%s", table->columns[0]); /* First column (ID) */
+    }
     
-    for (int i = 1; i < table->column_count; i++) {
+    for (size_t i = 1; i < table->column_count; i++) {
         fprintf(file, ",%s", table->columns[i]);
     }
     
@@ -161,8 +241,8 @@ static void write_csv_header(FILE* file, Table* table) {
 static Pair* find_pair_by_key(Node* obj_node, const char* key) {
     if (obj_node->type != NODE_OBJECT) return NULL;
     
-    for (int i = 0; i < obj_node->data.object.pair_count; i++) {
-        if (strcmp(obj_node->data.object.pairs[i]->key, key) == 0) {
+    for (size_t i = 0; i < obj_node->data.object.pair_count; i++) {
+        if (obj_node->data.object.pairs[i]->key == key) {
             return obj_node->data.object.pairs[i];
         }
     }
@@ -170,51 +250,121 @@ static Pair* find_pair_by_key(Node* obj_node, const char* key) {
     return NULL;
 }
 
+static int same_columns(const OutputFile* output, const Table* table) {
+    if (output->column_count != table->column_count) return 0;
+    for (size_t i = 0; i < table->column_count; i++) {
+        if (output->columns[i] != table->columns[i]) return 0;
+    }
+    return 1;
+}
+
+/* The file for a table's rows. A root table's file is started over, as
+ * generate_csv() reaches it, and nested rows are appended. With files
+ * kept open, starting over only drops the current document's rows, and
+ * the file stays open after close_table_file(). Returns NULL if the file
+ * cannot be written. */
+static FILE* open_table_file(CSVContext* context, Table* table, int root) {
+    char filepath[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s.csv", context->output_dir, table->name);
+
+    if (!context->keep_files_open) {
+        FILE* file = fopen(filepath, root ? "w" : "a");
+        if (!file) {
+            fprintf(stderr, root ? "Failed to create file %s\n" : "Failed to open nested file %s\n", filepath);
+        } else if (root) {
+            write_csv_header(file, table);
+        }
+        return file;
+    }
+
+    OutputFile* output = context->open_files;
+    while (output && output->name != table->name) {
+        output = output->next;
+    }
+
+    if (!output) {
+        FILE* file = fopen(filepath, "w");
+        if (!file) {
+            fprintf(stderr, "Failed to create file %s\n", filepath);
+            return NULL;
+        }
+        write_csv_header(file, table);
+
+        output = calloc(1, sizeof(OutputFile));
+        output->name = table->name;
+        output->columns = malloc(sizeof(char*) * table->column_count);
+        memcpy(output->columns, table->columns, sizeof(char*) * table->column_count);
+        output->column_count = table->column_count;
+        output->file = file;
+        output->document_start = ftell(file);
+        output->next = context->open_files;
+        context->open_files = output;
+        return file;
+    }
+
+    if (!same_columns(output, table)) {
+        if (!output->skipped) {
+            fprintf(stderr, "Warning: skipping %s rows with other columns than %s\n", table->name, filepath);
+            output->skipped = 1;
+        }
+        return NULL;
+    }
+    if (root) {
+        fflush(output->file);
+        if (ftruncate(fileno(output->file), output->document_start) == 0) {
+            fseek(output->file, 0, SEEK_END);
+        }
+    }
+    return output->file;
+}
+
+static void close_table_file(CSVContext* context, FILE* file) {
+    if (!context->keep_files_open) fclose(file);
+}
+
 /* Process an object and write it to CSV */
-static void process_object(Node* obj_node, Table* table, FILE* file, int id, Schema* schema, CSVContext* context);
+static void process_object(Node* obj_node, Table* table, FILE* file, long long id, Schema* schema, CSVContext* context);
 
 /* Process an array of objects and write them to CSV */
 static void process_array(Node* array_node, Table* table, FILE* file, Schema* schema, CSVContext* context) {
     if (array_node->type != NODE_ARRAY) return;
     
-    for (int i = 0; i < array_node->data.array.element_count; i++) {
+    for (size_t i = 0; i < array_node->data.array.element_count; i++) {
         Node* element = array_node->data.array.elements[i];
         if (element->type == NODE_OBJECT) {
+            if (!below_limit(table, context)) break;
             process_object(element, table, file, context->next_id++, schema, context);
         }
     }
 }
 
 /* Process a single object node and write it to CSV */
-static void process_object(Node* obj_node, Table* table, FILE* file, int id, Schema* schema, CSVContext* context) {
+static void process_object(Node* obj_node, Table* table, FILE* file, long long id, Schema* schema, CSVContext* context) {
     if (obj_node->type != NODE_OBJECT) return;
+    table->row_count++;
     
     /* Start with ID column */
-    fprintf(file, "%d", id);
+    fprintf(file, "%lld", id);
     
     /* Process all scalar columns in order */
-    for (int i = 1; i < table->column_count; i++) {
+    for (size_t i = 1; i < table->column_count; i++) {
         fprintf(file, ",");
         
         Pair* pair = find_pair_by_key(obj_node, table->columns[i]);
         if (pair) {
-            write_node_value(file, pair->value);
+            write_node_value(file, pair->value, context);
             
             /* Process nested objects and arrays */
             if (pair->value->type == NODE_OBJECT || pair->value->type == NODE_ARRAY) {
                 /* Find matching table for this nested structure */
                 Table* nested_table = schema->tables;
                 while (nested_table) {
-                    if (strcmp(nested_table->name, table->columns[i]) == 0) {
+                    if (nested_table->name == table->columns[i]) {
+                        if (!below_limit(nested_table, context)) break;
+
                         /* Found matching table, process nested structure */
-                        char filepath[512];
-                        snprintf(filepath, sizeof(filepath), "%s/%s.csv", context->output_dir, nested_table->name);
-                        
-                        FILE* nested_file = fopen(filepath, "a");
-                        if (!nested_file) {
-                            fprintf(stderr, "Failed to open nested file %s\n", filepath);
-                            continue;
-                        }
+                        FILE* nested_file = open_table_file(context, nested_table, 0);
+                        if (!nested_file) break;
                         
                         if (pair->value->type == NODE_OBJECT) {
                             process_object(pair->value, nested_table, nested_file, context->next_id++, schema, context);
@@ -222,7 +372,7 @@ static void process_object(Node* obj_node, Table* table, FILE* file, int id, Sch
                             process_array(pair->value, nested_table, nested_file, schema, context);
                         }
                         
-                        fclose(nested_file);
+                        close_table_file(context, nested_file);
                         break;
                     }
                     nested_table = nested_table->next;
@@ -237,10 +387,16 @@ static void process_object(Node* obj_node, Table* table, FILE* file, int id, Sch
 /* Generate CSV files from AST */
 void generate_csv(Node* root, Schema* schema, CSVContext* context) {
     if (!root || !schema || !context) return;
+
+    /* Rows from here on belong to this document */
+    for (OutputFile* output = context->open_files; output; output = output->next) {
+        fflush(output->file);
+        output->document_start = ftell(output->file);
+    }
     
     /* Process each field in the root object */
     if (root->type == NODE_OBJECT) {
-        for (int i = 0; i < root->data.object.pair_count; i++) {
+        for (size_t i = 0; i < root->data.object.pair_count; i++) {
             Pair* pair = root->data.object.pairs[i];
             Node* value = pair->value;
             
@@ -251,24 +407,18 @@ void generate_csv(Node* root, Schema* schema, CSVContext* context) {
                     /* Find matching table */
                     Table* table = schema->tables;
                     while (table) {
-                        if (strcmp(table->name, pair->key) == 0) {
-                            /* Create CSV file for this table */
-                            char filepath[512];
-                            snprintf(filepath, sizeof(filepath), "%s/%s.csv", context->output_dir, table->name);
-                            
-                            FILE* file = fopen(filepath, "w");
-                            if (!file) {
-                                fprintf(stderr, "Failed to create file %s\n", filepath);
-                                break;
-                            }
+                        if (table->name == pair->key) {
+                            /* Create CSV file for this table, with its header */
+                            FILE* file = open_table_file(context, table, 1);
+                            if (!file) break;
                             
-                            /* Write header */
-                            write_csv_header(file, table);
+                            /* Rows nested in earlier tables are gone */
+                            table->row_count = 0;
                             
                             /* Process array */
                             process_array(value, table, file, schema, context);
                             
-                            fclose(file);
+                            close_table_file(context, file);
                             break;
                         }
                         table = table->next;
@@ -1,16 +1,53 @@
 #ifndef CSV_GENERATOR_H
 #define CSV_GENERATOR_H
 
+#include <stdio.h>
 #include "ast.h"
 
+/* Row limits set with --limit: one for every table, and ones for named
+ * tables. A limit below zero means none. */
+typedef struct {
+    long long default_limit;
+    char** tables;
+    long long* limits;
+    int count;
+} RowLimits;
+
+/* A table's file kept open across documents */
+typedef struct OutputFile OutputFile;
+
 typedef struct {
     char* output_dir;  /* Directory for CSV files */
-    int next_id;       /* Counter for generating unique IDs */
+    long long next_id; /* Counter for generating unique IDs */
+    int format_numbers; /* Reformat numbers with %g instead of copying the input lexeme */
+    const RowLimits* limits; /* NULL if every row is written */
+    /* Set to keep each table's file open from one generate_csv() to the
+     * next, so that the rows of a batch of documents share one file per
+     * table under the first document's header. A table whose columns
+     * differ from that header is skipped. Keys must come from one symbol
+     * table for the whole batch. */
+    int keep_files_open;
+    OutputFile* open_files;
 } CSVContext;
 
+/* Parse a comma-separated list of limits: N for every table, TABLE=N for
+ * one. Returns NULL and copies a message into error if it is not valid. */
+RowLimits* parse_row_limits(const char* spec, char* error, size_t error_size);
+
+/* Rows that may be written to the named table, or -1 for no limit */
+long long row_limit(const RowLimits* limits, const char* table);
+
+void free_row_limits(RowLimits* limits);
+
 /* Initialize CSV generation context */
 CSVContext* init_csv_context(const char* output_dir);
 
+/* Write a scalar as one CSV field; objects, arrays and null are empty */
+void write_node_value(FILE* file, const Node* node, CSVContext* context);
+
+/* Write a table's header row */
+void write_csv_header(FILE* file, Table* table);
+
 /* Generate CSV files from AST */
 void generate_csv(Node* root, Schema* schema, CSVContext* context);
 
@@ -0,0 +1,323 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "csv_ndjson.h"
+#include "json_handler.h"
+
+#define CHECKPOINT_HEADER "csv_parser ndjson checkpoint 1"
+
+typedef struct NdjsonTable {
+    Table table;                /* Name, and columns from the first record */
+    FILE* file;
+    struct NdjsonTable* next;
+} NdjsonTable;
+
+struct NdjsonWriter {
+    CSVContext* context;
+    SymbolTable* symbols;       /* Local, in front of the parse's table */
+    const char* default_table;
+    const char* route_key;      /* NULL if records are not routed */
+    NdjsonTable* tables;
+    const char* checkpoint_path; /* NULL if checkpoints are off */
+    size_t checkpoint_interval;
+    size_t checkpointed;        /* Input offset of the last checkpoint */
+    size_t written;             /* Input offset after the last chunk written */
+};
+
+NdjsonWriter* create_ndjson_writer(CSVContext* context, SymbolTable* symbols,
+                                   const char* default_table, const char* route_key) {
+    NdjsonWriter* writer = calloc(1, sizeof(NdjsonWriter));
+    writer->context = context;
+    writer->symbols = create_local_symbol_table(symbols);
+    writer->default_table = intern_key(writer->symbols, default_table, strlen(default_table));
+    if (route_key) {
+        writer->route_key = intern_key(writer->symbols, route_key, strlen(route_key));
+    }
+    return writer;
+}
+
+void free_ndjson_writer(NdjsonWriter* writer) {
+    if (!writer) return;
+
+    NdjsonTable* table = writer->tables;
+    while (table) {
+        NdjsonTable* next = table->next;
+        if (table->file) fclose(table->file);
+        free(table->table.columns);
+        free(table);
+        table = next;
+    }
+    free_symbol_table(writer->symbols);
+    free(writer);
+}
+
+static NdjsonTable* find_table(NdjsonWriter* writer, const char* name) {
+    for (NdjsonTable* table = writer->tables; table; table = table->next) {
+        if (table->table.name == name) return table;
+    }
+    return NULL;
+}
+
+/* Start a table whose columns are the keys of record, and write its header */
+static NdjsonTable* create_table(NdjsonWriter* writer, const char* name, Node* record) {
+    NdjsonTable* table = calloc(1, sizeof(NdjsonTable));
+    table->table.name = name;
+    table->table.column_count = record->data.object.pair_count;
+    table->table.columns = malloc(sizeof(char*) * table->table.column_count);
+    for (size_t i = 0; i < table->table.column_count; i++) {
+        table->table.columns[i] = record->data.object.pairs[i]->key;
+    }
+    table->next = writer->tables;
+    writer->tables = table;
+
+    char filepath[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s.csv", writer->context->output_dir, name);
+    table->file = fopen(filepath, "w");
+    if (!table->file) {
+        fprintf(stderr, "Failed to create file %s\n", filepath);
+        return table;
+    }
+    write_csv_header(table->file, &table->table);
+    return table;
+}
+
+static Pair* find_pair(Node* object, const char* key) {
+    for (size_t i = 0; i < object->data.object.pair_count; i++) {
+        if (object->data.object.pairs[i]->key == key) return object->data.object.pairs[i];
+    }
+    return NULL;
+}
+
+static void write_row(NdjsonWriter* writer, NdjsonTable* table, Node* object);
+
+/* process_array() */
+static void write_rows(NdjsonWriter* writer, NdjsonTable* table, Node* array) {
+    for (size_t i = 0; i < array->data.array.element_count; i++) {
+        Node* element = array->data.array.elements[i];
+        if (element->type == NODE_OBJECT) write_row(writer, table, element);
+    }
+}
+
+/* process_object(). The row is finished before its nested rows are
+ * written, since a nested row may go to the same open file; ids are
+ * assigned in the same order either way. */
+static void write_row(NdjsonWriter* writer, NdjsonTable* table, Node* object) {
+    Table* columns = &table->table;
+    FILE* file = table->file;
+
+    long long limit = row_limit(writer->context->limits, columns->name);
+    if (limit >= 0 && columns->row_count >= limit) return;
+    columns->row_count++;
+
+    if (file) {
+        fprintf(file, "%lld", writer->context->next_id);
+        for (size_t i = 1; i < columns->column_count; i++) {
+            fprintf(file, ",");
+            Pair* pair = find_pair(object, columns->columns[i]);
+            if (pair) write_node_value(file, pair->value, writer->context);
+        }
+        fprintf(file, "\n");
+    }
+    writer->context->next_id++;
+
+    for (size_t i = 1; i < columns->column_count; i++) {
+        Pair* pair = find_pair(object, columns->columns[i]);
+        if (!pair || (pair->value->type != NODE_OBJECT && pair->value->type != NODE_ARRAY)) continue;
+
+        NdjsonTable* nested = find_table(writer, columns->columns[i]);
+        if (!nested) continue;
+        if (pair->value->type == NODE_OBJECT) {
+            write_row(writer, nested, pair->value);
+        } else {
+            write_rows(writer, nested, pair->value);
+        }
+    }
+}
+
+/* Table named by the record's route key, or the default table. Values
+ * that cannot be a file name in the output directory are not routed. */
+static const char* route(NdjsonWriter* writer, Node* record) {
+    if (writer->route_key) {
+        Pair* pair = find_pair(record, writer->route_key);
+        if (pair && pair->value->type == NODE_STRING) {
+            const JsonString* name = &pair->value->data.string;
+            if (name->length > 0 && name->chars[0] != '.' &&
+                !memchr(name->chars, '/', name->length) && !memchr(name->chars, '\0', name->length)) {
+                return intern_key(writer->symbols, name->chars, name->length);
+            }
+        }
+    }
+    return writer->default_table;
+}
+
+void set_ndjson_checkpoints(NdjsonWriter* writer, const char* path, size_t interval) {
+    writer->checkpoint_path = path;
+    writer->checkpoint_interval = interval;
+}
+
+/* Strings are written as their length, a space and their bytes, so names
+ * and keys may hold spaces or newlines */
+static void write_checkpoint_string(FILE* file, const char* string) {
+    fprintf(file, "%zu %s\n", strlen(string), string);
+}
+
+static const char* read_checkpoint_string(FILE* file, SymbolTable* symbols) {
+    size_t length;
+    if (fscanf(file, "%zu", &length) != 1 || fgetc(file) != ' ') return NULL;
+
+    char* bytes = malloc(length + 1);
+    const char* key = NULL;
+    if (fread(bytes, 1, length, file) == length && fgetc(file) == '\n') {
+        key = intern_key(symbols, bytes, length);
+    }
+    free(bytes);
+    return key;
+}
+
+int save_ndjson_checkpoint(NdjsonWriter* writer) {
+    char temp[512];
+    snprintf(temp, sizeof(temp), "%s.tmp", writer->checkpoint_path);
+    FILE* file = fopen(temp, "w");
+    if (!file) return -1;
+
+    size_t table_count = 0;
+    for (NdjsonTable* table = writer->tables; table; table = table->next) {
+        table_count++;
+    }
+    fprintf(file, "%s\noffset %zu\nnext_id %lld\ntables %zu\n", CHECKPOINT_HEADER,
+            writer->written, writer->context->next_id, table_count);
+
+    /* A table whose file could not be created has no size */
+    int failed = 0;
+    for (NdjsonTable* table = writer->tables; table; table = table->next) {
+        long size = -1;
+        if (table->file) {
+            if (fflush(table->file) != 0) failed = 1;
+            size = ftell(table->file);
+        }
+        fprintf(file, "%lld %ld %zu ", table->table.row_count, size, table->table.column_count);
+        write_checkpoint_string(file, table->table.name);
+        for (size_t i = 0; i < table->table.column_count; i++) {
+            write_checkpoint_string(file, table->table.columns[i]);
+        }
+    }
+
+    if (ferror(file)) failed = 1;
+    if (fclose(file) != 0) failed = 1;
+    if (failed || rename(temp, writer->checkpoint_path) != 0) {
+        remove(temp);
+        return -1;
+    }
+    writer->checkpointed = writer->written;
+    return 0;
+}
+
+/* Open a table's file for appending, cut back to its checkpointed size */
+static int reopen_table(NdjsonWriter* writer, NdjsonTable* table, long size,
+                        char* error, size_t error_size) {
+    char filepath[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s.csv", writer->context->output_dir, table->table.name);
+
+    struct stat st;
+    if (stat(filepath, &st) != 0 || st.st_size < size) {
+        snprintf(error, error_size, "%s is shorter than at the checkpoint", filepath);
+        return -1;
+    }
+    if (truncate(filepath, size) != 0 || !(table->file = fopen(filepath, "a"))) {
+        snprintf(error, error_size, "Could not reopen %s", filepath);
+        return -1;
+    }
+    return 0;
+}
+
+int resume_ndjson_checkpoint(NdjsonWriter* writer, const char* path, size_t* offset,
+                             char* error, size_t error_size) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        snprintf(error, error_size, "No checkpoint to resume from at %s", path);
+        return -1;
+    }
+
+    char header[64];
+    long long next_id;
+    size_t table_count;
+    int valid = fgets(header, sizeof(header), file) &&
+                strcmp(header, CHECKPOINT_HEADER "\n") == 0 &&
+                fscanf(file, " offset %zu next_id %lld tables %zu", offset, &next_id, &table_count) == 3 &&
+                fgetc(file) == '\n';
+
+    /* Tables are restored in the order they were saved */
+    NdjsonTable** tail = &writer->tables;
+    for (size_t t = 0; valid && t < table_count; t++) {
+        long long rows;
+        long size;
+        size_t column_count;
+        if (fscanf(file, "%lld %ld %zu ", &rows, &size, &column_count) != 3) {
+            valid = 0;
+            break;
+        }
+
+        NdjsonTable* table = calloc(1, sizeof(NdjsonTable));
+        table->table.row_count = rows;
+        table->table.columns = malloc(sizeof(char*) * (column_count ? column_count : 1));
+        *tail = table;
+        tail = &table->next;
+
+        table->table.name = read_checkpoint_string(file, writer->symbols);
+        valid = table->table.name != NULL;
+        for (size_t i = 0; valid && i < column_count; i++) {
+            table->table.columns[i] = read_checkpoint_string(file, writer->symbols);
+            valid = table->table.columns[i] != NULL;
+            if (valid) table->table.column_count++;
+        }
+        if (valid && size >= 0 && reopen_table(writer, table, size, error, error_size) != 0) {
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+
+    if (!valid) {
+        snprintf(error, error_size, "Checkpoint %s is not valid", path);
+        return -1;
+    }
+    writer->context->next_id = next_id;
+    writer->written = *offset;
+    writer->checkpointed = *offset;
+    return 0;
+}
+
+int write_ndjson_records(void* user, Node* records, size_t end) {
+    NdjsonWriter* writer = user;
+
+    for (size_t i = 0; i < records->data.array.element_count; i++) {
+        Node* record = records->data.array.elements[i];
+        if (record->type != NODE_OBJECT) continue;
+
+        const char* name = route(writer, record);
+        NdjsonTable* table = find_table(writer, name);
+        if (!table) {
+            /* An empty first record would make a table without an id column */
+            if (record->data.object.pair_count == 0) continue;
+            table = create_table(writer, name, record);
+        }
+        write_row(writer, table, record);
+    }
+
+    writer->written = end;
+    if (writer->checkpoint_path && writer->checkpoint_interval > 0 &&
+        end - writer->checkpointed >= writer->checkpoint_interval &&
+        save_ndjson_checkpoint(writer) != 0) {
+        fprintf(stderr, "Warning: Could not write checkpoint %s\n", writer->checkpoint_path);
+    }
+
+    /* Without routing, no row can be written once the default table is full */
+    if (!writer->route_key) {
+        NdjsonTable* table = find_table(writer, writer->default_table);
+        long long limit = row_limit(writer->context->limits, writer->default_table);
+        if (table && limit >= 0 && table->table.row_count >= limit) return JSON_STOP;
+    }
+    return JSON_CONTINUE;
+}
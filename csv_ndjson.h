@@ -0,0 +1,49 @@
+#ifndef CSV_NDJSON_H
+#define CSV_NDJSON_H
+
+#include "csv_generator.h"
+#include "symbol_table.h"
+
+/* CSV output for newline-delimited JSON, one record per line. A record
+ * that is an object is a row of the table named by the string value of
+ * its route key, or of the default table if it has none (or no route key
+ * is set). Other records are skipped. A table's file is created with the
+ * keys of its first record as columns, the first replaced by the generated
+ * id as in generate_csv(), and stays open for the rest of the input.
+ *
+ * A nested object or array under a column named after a table is written
+ * to that table, as in the other modes, but only if the table has already
+ * been seen, as with --stream. Ids are assigned in input order. */
+typedef struct NdjsonWriter NdjsonWriter;
+
+/* Keys are looked up through a local table in front of symbols, so
+ * records may be parsed on other threads while they are written */
+NdjsonWriter* create_ndjson_writer(CSVContext* context, SymbolTable* symbols,
+                                   const char* default_table, const char* route_key);
+
+/* Write one chunk of records, ending at input offset end; a
+ * JsonRecordsFn for parse_json_lines(). Saves a checkpoint if one is due. */
+int write_ndjson_records(void* writer, Node* records, size_t end);
+
+/* Checkpoints let a long conversion that stopped part way continue from
+ * where it was instead of from the start. A checkpoint records the input
+ * offset after the last chunk written, which begins a line, the next id,
+ * and each table's columns, row count and file size, the files being
+ * flushed first. With an interval set, one is saved to path (replacing
+ * the last) after every interval bytes of input. */
+void set_ndjson_checkpoints(NdjsonWriter* writer, const char* path, size_t interval);
+
+/* Save a checkpoint now. Returns 0, or -1 if it could not be written. */
+int save_ndjson_checkpoint(NdjsonWriter* writer);
+
+/* Before any record is written, continue from the checkpoint at path: the
+ * tables are reopened for appending, each truncated to its size at the
+ * checkpoint, and the ids and row counts carry on. Sets *offset to the
+ * input offset to parse from. Returns 0, or -1 with a message in error. */
+int resume_ndjson_checkpoint(NdjsonWriter* writer, const char* path, size_t* offset,
+                             char* error, size_t error_size);
+
+/* Close the files */
+void free_ndjson_writer(NdjsonWriter* writer);
+
+#endif /* CSV_NDJSON_H */
@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csv_ondemand.h"
+
+typedef struct {
+    JsonDocument* doc;
+    CSVContext* context;
+    Schema* schema;
+    JsonValue* slots;       /* Value of each column, 0 if absent, per open object */
+    size_t slot_count;
+    size_t slot_capacity;
+} OnDemandWriter;
+
+/* Add a table named name whose columns are the keys of object, in the
+ * order analyze_ast() uses (most recent table first) */
+static int add_table(OnDemandWriter* writer, const char* name, JsonValue object) {
+    JsonIterator it;
+    const char* key;
+    JsonValue value;
+    size_t capacity = 8;
+    int status;
+
+    Table* table = malloc(sizeof(Table));
+    table->name = name;
+    table->column_count = 0;
+    table->row_count = 0;
+    table->columns = malloc(sizeof(char*) * capacity);
+    table->next = writer->schema->tables;
+    writer->schema->tables = table;
+    writer->schema->table_count++;
+
+    if (json_object_iterate(writer->doc, object, &it) != 0) return -1;
+    while ((status = json_object_next(&it, &key, &value)) == 1) {
+        if (table->column_count == capacity) {
+            capacity *= 2;
+            table->columns = realloc(table->columns, sizeof(char*) * capacity);
+        }
+        table->columns[table->column_count++] = key;
+    }
+    return status;
+}
+
+/* First element of array if it is an object, else 0 */
+static int first_object(OnDemandWriter* writer, JsonValue array, JsonValue* first) {
+    JsonIterator it;
+
+    if (json_array_iterate(writer->doc, array, &it) != 0) return -1;
+    int status = json_array_next(&it, first);
+    if (status <= 0) {
+        *first = 0;
+        return status;
+    }
+    int type = json_value_type(writer->doc, *first);
+    if (type < 0) return -1;
+    if (type != NODE_OBJECT) *first = 0;
+    return 0;
+}
+
+/* analyze_ast() on the root, after main()'s wrapping of a root without
+ * arrays into a one-element "users" array. Sets *wrapped in that case. */
+static int build_schema(OnDemandWriter* writer, JsonValue root, int* wrapped) {
+    JsonDocument* doc = writer->doc;
+    JsonIterator it;
+    const char* key;
+    JsonValue value, first;
+    int has_array = 0, status;
+
+    *wrapped = 0;
+    if (json_value_type(doc, root) != NODE_OBJECT) return 0;
+
+    if (json_object_iterate(doc, root, &it) != 0) return -1;
+    while ((status = json_object_next(&it, &key, &value)) == 1) {
+        int type = json_value_type(doc, value);
+        if (type < 0) return -1;
+
+        if (type == NODE_ARRAY) {
+            has_array = 1;
+            if (first_object(writer, value, &first) != 0) return -1;
+            if (first && add_table(writer, key, first) != 0) return -1;
+        } else if (type == NODE_OBJECT) {
+            if (add_table(writer, key, value) != 0) return -1;
+        }
+    }
+    if (status < 0) return -1;
+
+    if (!has_array) {
+        Table* table = writer->schema->tables;
+        while (table) {
+            Table* next = table->next;
+            free(table->columns);
+            free(table);
+            table = next;
+        }
+        writer->schema->tables = NULL;
+        writer->schema->table_count = 0;
+        *wrapped = 1;
+        return add_table(writer, intern_key(doc->symbols, "users", strlen("users")), root);
+    }
+    return 0;
+}
+
+static Table* find_table(Schema* schema, const char* name) {
+    for (Table* table = schema->tables; table; table = table->next) {
+        if (table->name == name) return table;
+    }
+    return NULL;
+}
+
+static int write_object(OnDemandWriter* writer, JsonValue object, Table* table, FILE* file, long long id);
+
+/* process_array() */
+static int write_array(OnDemandWriter* writer, JsonValue array, Table* table, FILE* file) {
+    JsonIterator it;
+    JsonValue element;
+    int status;
+
+    if (json_array_iterate(writer->doc, array, &it) != 0) return -1;
+    while ((status = json_array_next(&it, &element)) == 1) {
+        int type = json_value_type(writer->doc, element);
+        if (type < 0) return -1;
+        if (type == NODE_OBJECT &&
+            write_object(writer, element, table, file, writer->context->next_id++) != 0) {
+            return -1;
+        }
+    }
+    return status;
+}
+
+/* A nested object or array under a column named after a table is written
+ * to that table's file, as process_object() does */
+static int write_nested(OnDemandWriter* writer, JsonValue value, int type, const char* column) {
+    Table* nested = find_table(writer->schema, column);
+    if (!nested) return 0;
+
+    char filepath[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s.csv", writer->context->output_dir, nested->name);
+    FILE* file = fopen(filepath, "a");
+    if (!file) {
+        fprintf(stderr, "Failed to open nested file %s\n", filepath);
+        return 0;
+    }
+
+    int status = type == NODE_OBJECT
+        ? write_object(writer, value, nested, file, writer->context->next_id++)
+        : write_array(writer, value, nested, file);
+    fclose(file);
+    return status;
+}
+
+/* process_object(): the object's members are read once to find the value
+ * of each column, then columns are written in table order */
+static int write_object(OnDemandWriter* writer, JsonValue object, Table* table, FILE* file, long long id) {
+    JsonDocument* doc = writer->doc;
+    JsonIterator it;
+    const char* key;
+    JsonValue value;
+    int status;
+
+    size_t base = writer->slot_count;
+    if (base + table->column_count > writer->slot_capacity) {
+        while (base + table->column_count > writer->slot_capacity) {
+            writer->slot_capacity = writer->slot_capacity ? writer->slot_capacity * 2 : 64;
+        }
+        writer->slots = realloc(writer->slots, writer->slot_capacity * sizeof(JsonValue));
+    }
+    if (table->column_count > 0) {
+        memset(writer->slots + base, 0, table->column_count * sizeof(JsonValue));
+    }
+    writer->slot_count = base + table->column_count;
+
+    /* The first member with a column's key is its value, as find_pair_by_key() */
+    if (json_object_iterate(doc, object, &it) != 0) return -1;
+    while ((status = json_object_next(&it, &key, &value)) == 1) {
+        for (size_t i = 1; i < table->column_count; i++) {
+            if (table->columns[i] == key && !writer->slots[base + i]) {
+                writer->slots[base + i] = value;
+            }
+        }
+    }
+    if (status < 0) return -1;
+
+    fprintf(file, "%lld", id);
+    for (size_t i = 1; i < table->column_count; i++) {
+        fprintf(file, ",");
+
+        /* Slots may move while nested objects are written */
+        value = writer->slots[base + i];
+        if (!value) continue;
+
+        int type = json_value_type(doc, value);
+        if (type < 0) return -1;
+
+        if (type == NODE_OBJECT || type == NODE_ARRAY) {
+            if (write_nested(writer, value, type, table->columns[i]) != 0) return -1;
+        } else {
+            Node scalar;
+            if (json_value_scalar(doc, value, &scalar) != 0) return -1;
+            write_node_value(file, &scalar, writer->context);
+            if (scalar.type == NODE_STRING && scalar.data.string.owned) {
+                free((char*)scalar.data.string.chars);
+            }
+        }
+    }
+    fprintf(file, "\n");
+
+    writer->slot_count = base;
+    return 0;
+}
+
+/* generate_csv() */
+static int write_tables(OnDemandWriter* writer, JsonValue root, int wrapped) {
+    JsonDocument* doc = writer->doc;
+    JsonIterator it;
+    const char* key;
+    JsonValue value, first;
+    int status;
+
+    if (wrapped) {
+        Table* table = writer->schema->tables;
+        char filepath[512];
+        snprintf(filepath, sizeof(filepath), "%s/%s.csv", writer->context->output_dir, table->name);
+        FILE* file = fopen(filepath, "w");
+        if (!file) {
+            fprintf(stderr, "Failed to create file %s\n", filepath);
+            return 0;
+        }
+        write_csv_header(file, table);
+        status = write_object(writer, root, table, file, writer->context->next_id++);
+        fclose(file);
+        return status;
+    }
+
+    if (json_value_type(doc, root) != NODE_OBJECT) return 0;
+
+    if (json_object_iterate(doc, root, &it) != 0) return -1;
+    while ((status = json_object_next(&it, &key, &value)) == 1) {
+        if (json_value_type(doc, value) != NODE_ARRAY) continue;
+        if (first_object(writer, value, &first) != 0) return -1;
+        if (!first) continue;
+
+        Table* table = find_table(writer->schema, key);
+        if (!table) continue;
+
+        char filepath[512];
+        snprintf(filepath, sizeof(filepath), "%s/%s.csv", writer->context->output_dir, table->name);
+        FILE* file = fopen(filepath, "w");
+        if (!file) {
+            fprintf(stderr, "Failed to create file %s\n", filepath);
+            continue;
+        }
+        write_csv_header(file, table);
+        int written = write_array(writer, value, table, file);
+        fclose(file);
+        if (written != 0) return -1;
+    }
+    return status;
+}
+
+int generate_csv_ondemand(JsonDocument* doc, CSVContext* context) {
+    OnDemandWriter writer = { doc, context, NULL, NULL, 0, 0 };
+    JsonValue root = json_document_root(doc);
+    int wrapped;
+
+    writer.schema = malloc(sizeof(Schema));
+    writer.schema->tables = NULL;
+    writer.schema->table_count = 0;
+
+    int status = build_schema(&writer, root, &wrapped);
+    if (status == 0) {
+        status = write_tables(&writer, root, wrapped);
+    }
+
+    free_schema(writer.schema);
+    free(writer.slots);
+    return status;
+}
@@ -0,0 +1,15 @@
+#ifndef CSV_ONDEMAND_H
+#define CSV_ONDEMAND_H
+
+#include "csv_generator.h"
+#include "ondemand.h"
+
+/* Write the same CSV files as analyze_ast() and generate_csv() do for the
+ * tree, reading the document through the on-demand cursor instead. Only
+ * the root keys, the keys of each table's first object and the values of
+ * table columns are scanned; all other values are skipped without being
+ * parsed or allocated. Returns 0, or -1 with a message in
+ * doc->lexer.error. */
+int generate_csv_ondemand(JsonDocument* doc, CSVContext* context);
+
+#endif /* CSV_ONDEMAND_H */
@@ -0,0 +1,466 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csv_stream.h"
+
+/* A table known to the stream. Root arrays of objects become tables with
+ * their own file; root objects only lend their keys as columns to nested
+ * rows, which are appended to the file without a header. */
+typedef struct StreamTable {
+    const char* name;
+    const char** columns;     /* columns[0] names the generated id */
+    size_t column_count;
+    size_t column_capacity;
+    FILE* file;
+    int append;               /* Opened with "a" when the first row arrives */
+    struct StreamTable* next;
+} StreamTable;
+
+typedef enum {
+    FRAME_ROOT,     /* The root object */
+    FRAME_ROWS,     /* An array whose object elements are rows */
+    FRAME_RECORD,   /* An object being collected into a row */
+    FRAME_COLUMNS   /* A root object whose keys become a table's columns */
+} FrameKind;
+
+/* One open container. Frames are kept when popped so the value slots of
+ * each depth are reused from record to record. */
+typedef struct {
+    FrameKind kind;
+    StreamTable* table;
+    const char* key;          /* Key of the value being read */
+    size_t column;            /* Column of key, 0 if it is the id or not one */
+    size_t next_column;       /* Column expected next, tried before a search */
+    long long id;             /* RECORD: generated id */
+    int learning;             /* Columns are taken from this object's keys */
+    int first_seen;           /* ROWS: the first element has been seen */
+    Node* values;             /* Scalar per column; strings point into the input */
+    char* present;
+    size_t value_capacity;
+} Frame;
+
+struct CSVStream {
+    CSVContext* context;
+    SymbolTable* symbols;
+    StreamTable* tables;      /* Most recent first, as the schema is built */
+    Frame* frames;
+    int depth;
+    int frame_capacity;
+    int skip_depth;           /* Depth inside a container that is ignored */
+    int root_has_array;
+    StreamTable users;        /* Root keys, for a root without arrays */
+};
+
+CSVStream* create_csv_stream(CSVContext* context, SymbolTable* symbols) {
+    CSVStream* stream = calloc(1, sizeof(CSVStream));
+    stream->context = context;
+    stream->symbols = symbols;
+    stream->users.name = intern_key(symbols, "users", strlen("users"));
+    return stream;
+}
+
+static FILE* open_table_file(CSVStream* stream, StreamTable* table, const char* mode) {
+    char filepath[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s.csv", stream->context->output_dir, table->name);
+
+    FILE* file = fopen(filepath, mode);
+    if (!file) {
+        fprintf(stderr, "Failed to %s file %s\n", mode[0] == 'a' ? "open nested" : "create", filepath);
+    }
+    return file;
+}
+
+static size_t add_column(StreamTable* table, const char* key) {
+    if (table->column_count == table->column_capacity) {
+        table->column_capacity = table->column_capacity ? table->column_capacity * 2 : 16;
+        table->columns = realloc(table->columns, table->column_capacity * sizeof(char*));
+    }
+    table->columns[table->column_count] = key;
+    return table->column_count++;
+}
+
+static StreamTable* create_table(const char* name) {
+    StreamTable* table = calloc(1, sizeof(StreamTable));
+    table->name = name;
+    return table;
+}
+
+static void free_table(StreamTable* table) {
+    if (table->file) fclose(table->file);
+    free(table->columns);
+}
+
+static StreamTable* find_table(CSVStream* stream, const char* name) {
+    for (StreamTable* table = stream->tables; table; table = table->next) {
+        if (table->name == name) return table;
+    }
+    return NULL;
+}
+
+static void register_table(CSVStream* stream, StreamTable* table) {
+    table->next = stream->tables;
+    stream->tables = table;
+}
+
+/* Column of key in the frame's table; keys usually come in column order */
+static size_t find_column(Frame* frame, const char* key) {
+    StreamTable* table = frame->table;
+
+    if (frame->next_column < table->column_count && table->columns[frame->next_column] == key) {
+        return frame->next_column++;
+    }
+    for (size_t i = 0; i < table->column_count; i++) {
+        if (table->columns[i] == key) {
+            frame->next_column = i + 1;
+            return i;
+        }
+    }
+    return 0;
+}
+
+static void clear_values(Frame* frame) {
+    for (size_t i = 0; i < frame->value_capacity; i++) {
+        if (!frame->present[i]) continue;
+        if (frame->values[i].type == NODE_STRING && frame->values[i].data.string.owned) {
+            free((char*)frame->values[i].data.string.chars);
+        } else if (frame->values[i].type == NODE_NUMBER && frame->values[i].data.number.owned) {
+            free((char*)frame->values[i].data.number.chars);
+        }
+    }
+    if (frame->value_capacity) {
+        memset(frame->present, 0, frame->value_capacity);
+    }
+}
+
+/* Keep a scalar for the current column. Like find_pair_by_key(), the
+ * first occurrence of a key wins. */
+static void store_value(Frame* frame, Node* value) {
+    if (frame->column == 0) return;
+
+    if (frame->column >= frame->value_capacity) {
+        size_t capacity = frame->value_capacity ? frame->value_capacity : 16;
+        while (capacity <= frame->column) capacity *= 2;
+        frame->values = realloc(frame->values, capacity * sizeof(Node));
+        frame->present = realloc(frame->present, capacity);
+        memset(frame->present + frame->value_capacity, 0, capacity - frame->value_capacity);
+        frame->value_capacity = capacity;
+    }
+    if (frame->present[frame->column]) return;
+
+    frame->values[frame->column] = *value;
+    frame->present[frame->column] = 1;
+    /* The frame frees an owned string or number with the row */
+    if (value->type == NODE_STRING) {
+        value->data.string.owned = 0;
+    } else if (value->type == NODE_NUMBER) {
+        value->data.number.owned = 0;
+    }
+}
+
+static void write_header(StreamTable* table) {
+    if (!table->file) return;
+
+    if (table->column_count > 0) {
+        fprintf(table->file, "%s", table->columns[0]);
+    }
+    for (size_t i = 1; i < table->column_count; i++) {
+        fprintf(table->file, ",%s", table->columns[i]);
+    }
+    fprintf(table->file, "\n");
+}
+
+static void write_row(CSVStream* stream, Frame* frame) {
+    StreamTable* table = frame->table;
+
+    if (!table->file && table->append) {
+        table->file = open_table_file(stream, table, "a");
+    }
+    if (!table->file) return;
+
+    fprintf(table->file, "%lld", frame->id);
+    for (size_t i = 1; i < table->column_count; i++) {
+        fprintf(table->file, ",");
+        if (i < frame->value_capacity && frame->present[i]) {
+            write_node_value(table->file, &frame->values[i], stream->context);
+        }
+    }
+    fprintf(table->file, "\n");
+}
+
+static Frame* push_frame(CSVStream* stream, FrameKind kind, StreamTable* table) {
+    if (stream->depth == stream->frame_capacity) {
+        int capacity = stream->frame_capacity ? stream->frame_capacity * 2 : 16;
+        stream->frames = realloc(stream->frames, capacity * sizeof(Frame));
+        memset(stream->frames + stream->frame_capacity, 0,
+               (capacity - stream->frame_capacity) * sizeof(Frame));
+        stream->frame_capacity = capacity;
+    }
+
+    Frame* frame = &stream->frames[stream->depth++];
+    frame->kind = kind;
+    frame->table = table;
+    frame->key = NULL;
+    frame->column = 0;
+    frame->next_column = 0;
+    frame->id = 0;
+    frame->learning = 0;
+    frame->first_seen = 0;
+    return frame;
+}
+
+static Frame* push_record(CSVStream* stream, StreamTable* table, int learning) {
+    Frame* frame = push_frame(stream, FRAME_RECORD, table);
+    frame->id = stream->context->next_id++;
+    frame->learning = learning;
+    return frame;
+}
+
+/* Table that a nested value under the frame's current key is written to,
+ * as process_object() finds it: the key must be a column of the record */
+static StreamTable* nested_table(CSVStream* stream, Frame* frame) {
+    if (frame->column == 0) return NULL;
+    return find_table(stream, frame->key);
+}
+
+static int stream_start_object(void* user, size_t offset) {
+    CSVStream* stream = user;
+    (void)offset;
+
+    if (stream->skip_depth) {
+        stream->skip_depth++;
+        return JSON_CONTINUE;
+    }
+    if (stream->depth == 0) {
+        Frame* frame = push_frame(stream, FRAME_ROOT, &stream->users);
+        frame->learning = 1;
+        return JSON_CONTINUE;
+    }
+
+    /* top is only valid until the next push, which may move the frames */
+    Frame* top = &stream->frames[stream->depth - 1];
+    StreamTable* table;
+    switch (top->kind) {
+        case FRAME_ROOT:
+            table = create_table(top->key);
+            table->append = 1;
+            push_frame(stream, FRAME_COLUMNS, table);
+            break;
+
+        case FRAME_ROWS:
+            if (!top->first_seen) {
+                /* A root array is a table if its first element is an object */
+                top->first_seen = 1;
+                table = create_table(top->key);
+                table->file = open_table_file(stream, table, "w");
+                if (!table->file) {
+                    free_table(table);
+                    free(table);
+                    stream->skip_depth = 1;
+                    break;
+                }
+                register_table(stream, table);
+                top->table = table;
+                push_record(stream, table, 1);
+            } else if (top->table) {
+                push_record(stream, top->table, 0);
+            } else {
+                stream->skip_depth = 1;
+            }
+            break;
+
+        case FRAME_RECORD:
+            table = nested_table(stream, top);
+            if (table) {
+                push_record(stream, table, 0);
+            } else {
+                stream->skip_depth = 1;
+            }
+            break;
+
+        case FRAME_COLUMNS:
+            stream->skip_depth = 1;
+            break;
+    }
+    return JSON_CONTINUE;
+}
+
+static int stream_end_object(void* user) {
+    CSVStream* stream = user;
+
+    if (stream->skip_depth) {
+        stream->skip_depth--;
+        return JSON_CONTINUE;
+    }
+
+    Frame* frame = &stream->frames[--stream->depth];
+    switch (frame->kind) {
+        case FRAME_RECORD:
+            if (frame->learning) {
+                write_header(frame->table);
+            }
+            write_row(stream, frame);
+            clear_values(frame);
+            break;
+
+        case FRAME_COLUMNS:
+            register_table(stream, frame->table);
+            break;
+
+        case FRAME_ROOT:
+        case FRAME_ROWS:
+            break;
+    }
+    return JSON_CONTINUE;
+}
+
+static int stream_start_array(void* user, size_t offset) {
+    CSVStream* stream = user;
+    (void)offset;
+
+    if (stream->skip_depth) {
+        stream->skip_depth++;
+        return JSON_CONTINUE;
+    }
+    if (stream->depth == 0) {
+        /* Only a root object holds tables */
+        stream->skip_depth = 1;
+        return JSON_CONTINUE;
+    }
+
+    Frame* top = &stream->frames[stream->depth - 1];
+    const char* name = top->key;
+    Frame* frame;
+    StreamTable* table;
+    switch (top->kind) {
+        case FRAME_ROOT:
+            stream->root_has_array = 1;
+            frame = push_frame(stream, FRAME_ROWS, NULL);
+            frame->key = name;  /* Table name, if the first element is an object */
+            break;
+
+        case FRAME_RECORD:
+            table = nested_table(stream, top);
+            if (table) {
+                frame = push_frame(stream, FRAME_ROWS, table);
+                frame->first_seen = 1;
+            } else {
+                stream->skip_depth = 1;
+            }
+            break;
+
+        case FRAME_ROWS:
+            top->first_seen = 1;
+            stream->skip_depth = 1;
+            break;
+
+        case FRAME_COLUMNS:
+            stream->skip_depth = 1;
+            break;
+    }
+    return JSON_CONTINUE;
+}
+
+static int stream_end_array(void* user) {
+    CSVStream* stream = user;
+
+    if (stream->skip_depth) {
+        stream->skip_depth--;
+    } else {
+        stream->depth--;
+    }
+    return JSON_CONTINUE;
+}
+
+static int stream_key(void* user, const char* key) {
+    CSVStream* stream = user;
+
+    if (stream->skip_depth) return JSON_CONTINUE;
+
+    Frame* frame = &stream->frames[stream->depth - 1];
+    frame->key = key;
+    if (frame->kind == FRAME_COLUMNS || frame->learning) {
+        frame->column = add_column(frame->table, key);
+    } else if (frame->kind == FRAME_RECORD) {
+        frame->column = find_column(frame, key);
+    }
+    return JSON_CONTINUE;
+}
+
+static int stream_scalar(void* user, Node* value) {
+    CSVStream* stream = user;
+
+    if (stream->skip_depth || stream->depth == 0) return JSON_CONTINUE;
+
+    Frame* frame = &stream->frames[stream->depth - 1];
+    switch (frame->kind) {
+        case FRAME_ROOT:
+            if (!stream->root_has_array) store_value(frame, value);
+            break;
+        case FRAME_RECORD:
+            store_value(frame, value);
+            break;
+        case FRAME_ROWS:
+            frame->first_seen = 1;
+            break;
+        case FRAME_COLUMNS:
+            break;
+    }
+    return JSON_CONTINUE;
+}
+
+const JsonHandler csv_stream_handler = {
+    stream_start_object,
+    stream_end_object,
+    stream_start_array,
+    stream_end_array,
+    stream_key,
+    stream_scalar
+};
+
+void finish_csv_stream(CSVStream* stream) {
+    /* A root object without arrays is a single "users" record, the way
+     * main() wraps it for the AST generator */
+    if (stream->frame_capacity > 0 && stream->frames[0].kind == FRAME_ROOT &&
+        !stream->root_has_array) {
+        Frame* root = &stream->frames[0];
+        StreamTable* users = &stream->users;
+
+        users->file = open_table_file(stream, users, "w");
+        if (users->file) {
+            root->id = stream->context->next_id++;
+            write_header(users);
+            write_row(stream, root);
+            fclose(users->file);
+            users->file = NULL;
+        }
+    }
+
+    for (StreamTable* table = stream->tables; table; table = table->next) {
+        if (table->file) {
+            fclose(table->file);
+            table->file = NULL;
+        }
+    }
+}
+
+void free_csv_stream(CSVStream* stream) {
+    if (!stream) return;
+
+    for (int i = 0; i < stream->frame_capacity; i++) {
+        Frame* frame = &stream->frames[i];
+        if (frame->value_capacity) clear_values(frame);
+        free(frame->values);
+        free(frame->present);
+    }
+    free(stream->frames);
+
+    StreamTable* table = stream->tables;
+    while (table) {
+        StreamTable* next = table->next;
+        free_table(table);
+        free(table);
+        table = next;
+    }
+    free_table(&stream->users);
+    free(stream);
+}
@@ -0,0 +1,31 @@
+#ifndef CSV_STREAM_H
+#define CSV_STREAM_H
+
+#include "csv_generator.h"
+#include "json_handler.h"
+#include "symbol_table.h"
+
+/* CSV generator driven by parser events instead of an AST. Each row is
+ * written as soon as its object closes, so memory is bounded by the
+ * widest record and the nesting depth, not by the document.
+ *
+ * It produces the same tables as generate_csv() with one difference that
+ * follows from reading the input once: a nested object or array is only
+ * written to a table that appeared earlier in the document. Ids are
+ * assigned in document order. */
+typedef struct CSVStream CSVStream;
+
+/* Event handler to pass to parse_json_events() with a CSVStream as user */
+extern const JsonHandler csv_stream_handler;
+
+/* Keys must be interned in symbols, the table the parse uses */
+CSVStream* create_csv_stream(CSVContext* context, SymbolTable* symbols);
+
+/* Write what can only be written at the end of the document (a root
+ * object without arrays becomes a one-row "users" table) and close the
+ * files */
+void finish_csv_stream(CSVStream* stream);
+
+void free_csv_stream(CSVStream* stream);
+
+#endif /* CSV_STREAM_H */
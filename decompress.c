@@ -0,0 +1,720 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "decompress.h"
+
+/* zlib counts bytes in 32 bits, so larger spans are passed in pieces */
+#define ZLIB_MAX_SPAN (1u << 30)
+
+Compression detect_compression(const char* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    if (length >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+        return COMPRESSION_GZIP;
+    }
+    if (length >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd) {
+        return COMPRESSION_ZSTD;
+    }
+    return COMPRESSION_NONE;
+}
+
+const char* compression_name(Compression compression) {
+    switch (compression) {
+        case COMPRESSION_GZIP: return "gzip";
+        case COMPRESSION_ZSTD: return "zstd";
+        default: return "uncompressed";
+    }
+}
+
+/* State of one decompression, shared by the in-memory and threaded paths */
+typedef struct {
+    Compression compression;
+    const unsigned char* next;  /* Compressed bytes not yet consumed */
+    size_t avail;
+    z_stream zlib;
+#ifdef HAVE_ZSTD
+    ZSTD_DStream* zstd;
+#endif
+    char error[256];
+} Inflater;
+
+static int init_inflater(Inflater* inflater, const char* data, size_t length,
+                         Compression compression) {
+    memset(inflater, 0, sizeof(Inflater));
+    inflater->compression = compression;
+    inflater->next = (const unsigned char*)data;
+    inflater->avail = length;
+
+    if (compression == COMPRESSION_GZIP) {
+        /* 16 + window bits: gzip header and trailer, not a zlib stream */
+        if (inflateInit2(&inflater->zlib, 16 + MAX_WBITS) != Z_OK) {
+            snprintf(inflater->error, sizeof(inflater->error), "Could not start gzip decompression");
+            return -1;
+        }
+        return 0;
+    }
+#ifdef HAVE_ZSTD
+    if (compression == COMPRESSION_ZSTD) {
+        inflater->zstd = ZSTD_createDStream();
+        if (!inflater->zstd || ZSTD_isError(ZSTD_initDStream(inflater->zstd))) {
+            snprintf(inflater->error, sizeof(inflater->error), "Could not start zstd decompression");
+            return -1;
+        }
+        return 0;
+    }
+#endif
+    snprintf(inflater->error, sizeof(inflater->error),
+             "%s input is not supported by this build", compression_name(compression));
+    return -1;
+}
+
+static void free_inflater(Inflater* inflater) {
+    if (inflater->compression == COMPRESSION_GZIP) {
+        inflateEnd(&inflater->zlib);
+    }
+#ifdef HAVE_ZSTD
+    if (inflater->zstd) ZSTD_freeDStream(inflater->zstd);
+#endif
+}
+
+/* Fill out with up to capacity bytes of gzip output. A member that ends
+ * where another begins is followed into the next one. */
+static int inflate_gzip(Inflater* inflater, char* out, size_t capacity, size_t* produced) {
+    z_stream* zlib = &inflater->zlib;
+    *produced = 0;
+
+    while (*produced < capacity) {
+        uInt in_span = inflater->avail > ZLIB_MAX_SPAN ? ZLIB_MAX_SPAN : (uInt)inflater->avail;
+        uInt out_span = capacity - *produced > ZLIB_MAX_SPAN ? ZLIB_MAX_SPAN
+                                                             : (uInt)(capacity - *produced);
+        zlib->next_in = (Bytef*)inflater->next;
+        zlib->avail_in = in_span;
+        zlib->next_out = (Bytef*)out + *produced;
+        zlib->avail_out = out_span;
+
+        int result = inflate(zlib, Z_NO_FLUSH);
+        inflater->next += in_span - zlib->avail_in;
+        inflater->avail -= in_span - zlib->avail_in;
+        *produced += out_span - zlib->avail_out;
+
+        if (result == Z_STREAM_END) {
+            if (inflater->avail >= 2 && inflater->next[0] == 0x1f && inflater->next[1] == 0x8b) {
+                inflateReset(zlib);
+                continue;
+            }
+            /* As with gzip -d, anything after the last member is ignored */
+            return 1;
+        }
+        if (result == Z_BUF_ERROR && inflater->avail == 0) {
+            snprintf(inflater->error, sizeof(inflater->error), "gzip data ends unexpectedly");
+            return -1;
+        }
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            snprintf(inflater->error, sizeof(inflater->error), "gzip data is corrupt: %s",
+                     zlib->msg ? zlib->msg : "invalid data");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+#ifdef HAVE_ZSTD
+/* Fill out with up to capacity bytes of zstd output; consecutive frames
+ * are decoded as one stream */
+static int inflate_zstd(Inflater* inflater, char* out, size_t capacity, size_t* produced) {
+    ZSTD_inBuffer in = { inflater->next, inflater->avail, 0 };
+    ZSTD_outBuffer output = { out, capacity, 0 };
+    int status = 0;
+
+    for (;;) {
+        size_t result = ZSTD_decompressStream(inflater->zstd, &output, &in);
+        if (ZSTD_isError(result)) {
+            snprintf(inflater->error, sizeof(inflater->error), "zstd data is corrupt: %s",
+                     ZSTD_getErrorName(result));
+            status = -1;
+            break;
+        }
+        if (result == 0 && in.pos == in.size) {
+            status = 1;
+            break;
+        }
+        if (output.pos == output.size) break;
+        if (in.pos == in.size) {
+            snprintf(inflater->error, sizeof(inflater->error), "zstd data ends unexpectedly");
+            status = -1;
+            break;
+        }
+    }
+
+    inflater->next += in.pos;
+    inflater->avail -= in.pos;
+    *produced = output.pos;
+    return status;
+}
+#endif
+
+/* Returns 0 once out is full, 1 at the end of the data, -1 on an error */
+static int inflate_some(Inflater* inflater, char* out, size_t capacity, size_t* produced) {
+#ifdef HAVE_ZSTD
+    if (inflater->compression == COMPRESSION_ZSTD) {
+        return inflate_zstd(inflater, out, capacity, produced);
+    }
+#endif
+    return inflate_gzip(inflater, out, capacity, produced);
+}
+
+/* Decompressed size as recorded by the format, or 0 if it is not known.
+ * gzip keeps the size of the last member modulo 2^32, so it is only a
+ * first guess at the buffer size. */
+static size_t size_hint(const InputBuffer* input, Compression compression) {
+    const unsigned char* bytes = (const unsigned char*)input->data;
+    if (compression == COMPRESSION_GZIP && input->length >= 18) {
+        const unsigned char* trailer = bytes + input->length - 4;
+        return (size_t)trailer[0] | (size_t)trailer[1] << 8 |
+               (size_t)trailer[2] << 16 | (size_t)trailer[3] << 24;
+    }
+#ifdef HAVE_ZSTD
+    if (compression == COMPRESSION_ZSTD) {
+        unsigned long long size = ZSTD_getFrameContentSize(input->data, input->length);
+        if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR) {
+            return (size_t)size;
+        }
+    }
+#endif
+    return 0;
+}
+
+
+/* A run of consecutive gzip members whose sizes are known before any is
+ * inflated, so runs can be inflated independently and in any order */
+typedef struct {
+    size_t start;           /* Offset of the first member in the input */
+    size_t length;          /* Compressed bytes */
+    size_t output_start;    /* Offset of the run's output in the whole output */
+    size_t output_length;
+} MemberRun;
+
+/* Members are grouped into runs of at least this much output */
+#define MEMBER_RUN_SIZE DECOMPRESS_CHUNK_SIZE
+
+static size_t read_le16(const unsigned char* bytes) {
+    return (size_t)bytes[0] | (size_t)bytes[1] << 8;
+}
+
+/* Size of the gzip member at member, from the block size that BGZF writes
+ * in the "BC" subfield of the header's extra field, or 0 if there is none */
+static size_t recorded_member_size(const unsigned char* member, size_t avail) {
+    if (avail < 18 || member[0] != 0x1f || member[1] != 0x8b || member[2] != 8 ||
+        !(member[3] & 0x04)) {
+        return 0;
+    }
+
+    size_t extra_end = 12 + read_le16(member + 10);
+    if (extra_end > avail) return 0;
+    for (size_t field = 12; field + 4 <= extra_end; field += 4 + read_le16(member + field + 2)) {
+        if (member[field] == 'B' && member[field + 1] == 'C' &&
+            read_le16(member + field + 2) == 2 && field + 6 <= extra_end) {
+            size_t size = read_le16(member + field + 4) + 1;
+            return size >= extra_end + 8 && size <= avail ? size : 0;
+        }
+    }
+    return 0;
+}
+
+/* Split a gzip input into runs of members when every member records its
+ * size, as BGZF blocks do. Returns the number of runs, or 0 if there is
+ * nothing to split and the input must be inflated serially. */
+static size_t plan_member_runs(const char* data, size_t length, MemberRun** runs,
+                               size_t* output_length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t capacity = 16;
+    size_t count = 0;
+    MemberRun* list = malloc(capacity * sizeof(MemberRun));
+    size_t output = 0;
+
+    for (size_t offset = 0; offset < length; ) {
+        size_t size = recorded_member_size(bytes + offset, length - offset);
+        if (size == 0) {
+            free(list);
+            return 0;
+        }
+
+        /* The trailer ends with the member's uncompressed size */
+        const unsigned char* trailer = bytes + offset + size - 4;
+        size_t member_output = read_le16(trailer) | read_le16(trailer + 2) << 16;
+
+        if (count == 0 || list[count - 1].output_length >= MEMBER_RUN_SIZE) {
+            if (count == capacity) {
+                capacity *= 2;
+                list = realloc(list, capacity * sizeof(MemberRun));
+            }
+            list[count].start = offset;
+            list[count].length = 0;
+            list[count].output_start = output;
+            list[count].output_length = 0;
+            count++;
+        }
+        list[count - 1].length += size;
+        list[count - 1].output_length += member_output;
+        output += member_output;
+        offset += size;
+    }
+
+    if (count < 2) {
+        free(list);
+        return 0;
+    }
+    *runs = list;
+    *output_length = output;
+    return count;
+}
+
+/* Inflate a run into exactly its output length at out. The sizes come
+ * from the headers, so the members must be checked to end where they say. */
+static int inflate_run(const char* data, const MemberRun* run, char* out,
+                       char* error, size_t error_size) {
+    Inflater inflater;
+    int status = -1;
+
+    if (init_inflater(&inflater, data + run->start, run->length, COMPRESSION_GZIP) == 0) {
+        size_t produced;
+        size_t extra_produced = 0;
+        char extra;
+        int result = inflate_some(&inflater, out, run->output_length, &produced);
+        if (result == 0) {
+            result = inflate_some(&inflater, &extra, 1, &extra_produced);
+        }
+
+        if (result == 1 && produced == run->output_length && extra_produced == 0 &&
+            inflater.avail == 0) {
+            status = 0;
+        } else if (result >= 0) {
+            snprintf(inflater.error, sizeof(inflater.error),
+                     "gzip member sizes do not match their data");
+        }
+    }
+
+    if (status != 0) snprintf(error, error_size, "%s", inflater.error);
+    free_inflater(&inflater);
+    return status;
+}
+
+/* Runs inflated in place into one buffer by a pool of threads */
+typedef struct {
+    const char* data;
+    const MemberRun* runs;
+    size_t run_count;
+    char* output;
+    size_t next_run;        /* First run not yet claimed */
+    size_t failed_run;      /* First run that failed, or run_count */
+    char error[256];
+    pthread_mutex_t lock;
+} RunPool;
+
+static void* inflate_pool_runs(void* arg) {
+    RunPool* pool = arg;
+    char error[256];
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        size_t index = pool->next_run;
+        if (index < pool->failed_run) pool->next_run++;
+        pthread_mutex_unlock(&pool->lock);
+        if (index >= pool->failed_run) break;
+
+        const MemberRun* run = &pool->runs[index];
+        if (inflate_run(pool->data, run, pool->output + run->output_start,
+                        error, sizeof(error)) != 0) {
+            pthread_mutex_lock(&pool->lock);
+            if (index < pool->failed_run) {
+                pool->failed_run = index;
+                snprintf(pool->error, sizeof(pool->error), "%s", error);
+            }
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+    return NULL;
+}
+
+/* Inflate the runs on threads threads, the calling one included.
+ * Returns 0, or -1 with the message of the first run that failed. */
+static int inflate_runs_in_place(const char* data, const MemberRun* runs, size_t run_count,
+                                 char* output, int threads, char* error, size_t error_size) {
+    RunPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.data = data;
+    pool.runs = runs;
+    pool.run_count = run_count;
+    pool.output = output;
+    pool.failed_run = run_count;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    pthread_t* ids = malloc(threads * sizeof(pthread_t));
+    int started = 0;
+    while (started < threads - 1 &&
+           pthread_create(&ids[started], NULL, inflate_pool_runs, &pool) == 0) {
+        started++;
+    }
+    inflate_pool_runs(&pool);
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    free(ids);
+    pthread_mutex_destroy(&pool.lock);
+
+    if (pool.failed_run < run_count) {
+        snprintf(error, error_size, "%s", pool.error);
+        return -1;
+    }
+    return 0;
+}
+
+InputBuffer* decompress_input(const InputBuffer* input, Compression compression, int threads,
+                              char* error, size_t error_size) {
+    /* Members that record their sizes are inflated in parallel, each
+     * straight to its place in the output */
+    MemberRun* runs;
+    size_t total;
+    size_t run_count = 0;
+    if (compression == COMPRESSION_GZIP && threads > 1) {
+        run_count = plan_member_runs(input->data, input->length, &runs, &total);
+    }
+    if (run_count > 0) {
+        char* data = malloc(total + INPUT_PADDING);
+        if (!data) {
+            free(runs);
+            snprintf(error, error_size, "Out of memory decompressing gzip input");
+            return NULL;
+        }
+        int status = inflate_runs_in_place(input->data, runs, run_count, data, threads,
+                                           error, error_size);
+        free(runs);
+        if (status != 0) {
+            free(data);
+            return NULL;
+        }
+
+        memset(data + total, 0, INPUT_PADDING);
+        InputBuffer* output = malloc(sizeof(InputBuffer));
+        output->data = data;
+        output->length = total;
+        output->mapped = 0;
+        return output;
+    }
+
+    Inflater inflater;
+    if (init_inflater(&inflater, input->data, input->length, compression) != 0) {
+        snprintf(error, error_size, "%s", inflater.error);
+        free_inflater(&inflater);
+        return NULL;
+    }
+
+    /* Output goes straight into the padded buffer the parser will read */
+    size_t capacity = size_hint(input, compression);
+    if (capacity < input->length * 2) capacity = input->length * 2;
+    if (capacity < (1 << 16)) capacity = 1 << 16;
+    size_t length = 0;
+    char* data = malloc(capacity + INPUT_PADDING);
+
+    int result = 0;
+    while (data && result == 0) {
+        if (length == capacity) {
+            capacity *= 2;
+            char* grown = realloc(data, capacity + INPUT_PADDING);
+            if (!grown) {
+                free(data);
+                data = NULL;
+                break;
+            }
+            data = grown;
+        }
+
+        size_t produced;
+        result = inflate_some(&inflater, data + length, capacity - length, &produced);
+        length += produced;
+    }
+
+    InputBuffer* output = NULL;
+    if (!data) {
+        snprintf(error, error_size, "Out of memory decompressing %s input",
+                 compression_name(compression));
+    } else if (result < 0) {
+        snprintf(error, error_size, "%s", inflater.error);
+        free(data);
+    } else {
+        memset(data + length, 0, INPUT_PADDING);
+        output = malloc(sizeof(InputBuffer));
+        output->data = data;
+        output->length = length;
+        output->mapped = 0;
+    }
+    free_inflater(&inflater);
+    return output;
+}
+
+/* Output of one run, in the ring the parallel workers fill */
+typedef struct {
+    char* data;
+    size_t capacity;
+    int ready;
+} RunSlot;
+
+struct Decompressor {
+    const char* data;
+    size_t taken;                           /* Chunks handed to the reader */
+    int holding;                            /* The reader still has chunk taken - 1 */
+    int stop;
+    char error[256];
+    pthread_mutex_t lock;
+    pthread_cond_t chunk_filled;
+    pthread_cond_t slot_freed;
+
+    /* One thread inflating the whole stream into fixed-size chunks */
+    Inflater inflater;
+    int started;                            /* The inflater was set up */
+    char* slots[DECOMPRESS_SLOTS];          /* Ring indexed by chunk number */
+    size_t lengths[DECOMPRESS_SLOTS];
+    size_t filled;                          /* Chunks inflated */
+    int done;                               /* 1 at the end of the data, -1 on an error */
+    pthread_t thread;
+
+    /* Or several, each inflating one run of members at a time; a chunk is
+     * the output of one run */
+    MemberRun* runs;                        /* NULL for one thread */
+    size_t run_count;
+    size_t claimed;                         /* Runs claimed by workers */
+    size_t failed_run;                      /* First run that failed, or run_count */
+    RunSlot* run_slots;                     /* Ring indexed by run number */
+    size_t slot_count;
+    pthread_t* workers;
+    int worker_count;
+};
+
+static void* inflate_chunks(void* arg) {
+    Decompressor* decompressor = arg;
+
+    pthread_mutex_lock(&decompressor->lock);
+    while (!decompressor->done) {
+        while (!decompressor->stop &&
+               decompressor->filled - (decompressor->taken - decompressor->holding) == DECOMPRESS_SLOTS) {
+            pthread_cond_wait(&decompressor->slot_freed, &decompressor->lock);
+        }
+        if (decompressor->stop) break;
+
+        size_t slot = decompressor->filled % DECOMPRESS_SLOTS;
+        pthread_mutex_unlock(&decompressor->lock);
+
+        size_t produced = 0;
+        int result = decompressor->started
+                         ? inflate_some(&decompressor->inflater, decompressor->slots[slot],
+                                        DECOMPRESS_CHUNK_SIZE, &produced)
+                         : -1;
+
+        pthread_mutex_lock(&decompressor->lock);
+        decompressor->lengths[slot] = produced;
+        if (produced > 0) decompressor->filled++;
+        if (result < 0) {
+            snprintf(decompressor->error, sizeof(decompressor->error), "%s",
+                     decompressor->inflater.error);
+        }
+        decompressor->done = result;
+        pthread_cond_broadcast(&decompressor->chunk_filled);
+    }
+    pthread_mutex_unlock(&decompressor->lock);
+    return NULL;
+}
+
+static void* inflate_run_slots(void* arg) {
+    Decompressor* decompressor = arg;
+    char error[256];
+
+    pthread_mutex_lock(&decompressor->lock);
+    for (;;) {
+        while (!decompressor->stop && decompressor->claimed < decompressor->run_count &&
+               decompressor->claimed - (decompressor->taken - decompressor->holding) ==
+                   decompressor->slot_count) {
+            pthread_cond_wait(&decompressor->slot_freed, &decompressor->lock);
+        }
+        if (decompressor->stop || decompressor->claimed >= decompressor->run_count) break;
+
+        size_t index = decompressor->claimed++;
+        const MemberRun* run = &decompressor->runs[index];
+        RunSlot* slot = &decompressor->run_slots[index % decompressor->slot_count];
+        pthread_mutex_unlock(&decompressor->lock);
+
+        /* The slot is this worker's until the reader has taken the run */
+        int status = -1;
+        if (slot->capacity < run->output_length) {
+            free(slot->data);
+            slot->data = malloc(run->output_length);
+            slot->capacity = slot->data ? run->output_length : 0;
+        }
+        if (slot->capacity >= run->output_length) {
+            status = inflate_run(decompressor->data, run, slot->data, error, sizeof(error));
+        } else {
+            snprintf(error, sizeof(error), "Out of memory decompressing gzip input");
+        }
+
+        pthread_mutex_lock(&decompressor->lock);
+        if (status != 0 && index < decompressor->failed_run) {
+            decompressor->failed_run = index;
+            snprintf(decompressor->error, sizeof(decompressor->error), "%s", error);
+        }
+        slot->ready = 1;
+        pthread_cond_broadcast(&decompressor->chunk_filled);
+    }
+    pthread_mutex_unlock(&decompressor->lock);
+    return NULL;
+}
+
+/* Start threads workers over the input's member runs. Returns 0 if the
+ * input cannot be split or no worker starts, and one thread must do. */
+static int start_run_workers(Decompressor* decompressor, size_t length, int threads) {
+    size_t total;
+    decompressor->run_count = plan_member_runs(decompressor->data, length,
+                                               &decompressor->runs, &total);
+    if (decompressor->run_count == 0) return 0;
+
+    decompressor->failed_run = decompressor->run_count;
+    decompressor->slot_count = (size_t)threads * 2;
+    decompressor->run_slots = calloc(decompressor->slot_count, sizeof(RunSlot));
+    decompressor->workers = malloc(threads * sizeof(pthread_t));
+    while (decompressor->worker_count < threads &&
+           pthread_create(&decompressor->workers[decompressor->worker_count], NULL,
+                          inflate_run_slots, decompressor) == 0) {
+        decompressor->worker_count++;
+    }
+    if (decompressor->worker_count > 0) return 1;
+
+    free(decompressor->workers);
+    free(decompressor->run_slots);
+    free(decompressor->runs);
+    decompressor->workers = NULL;
+    decompressor->run_slots = NULL;
+    decompressor->runs = NULL;
+    return 0;
+}
+
+Decompressor* start_decompressor(const char* data, size_t length, Compression compression,
+                                 int threads) {
+    Decompressor* decompressor = calloc(1, sizeof(Decompressor));
+    decompressor->data = data;
+    pthread_mutex_init(&decompressor->lock, NULL);
+    pthread_cond_init(&decompressor->chunk_filled, NULL);
+    pthread_cond_init(&decompressor->slot_freed, NULL);
+
+    if (compression == COMPRESSION_GZIP && threads > 1 &&
+        start_run_workers(decompressor, length, threads)) {
+        return decompressor;
+    }
+
+    /* A setup error is reported by the first decompressor_next() */
+    decompressor->started = init_inflater(&decompressor->inflater, data, length, compression) == 0;
+    for (int i = 0; i < DECOMPRESS_SLOTS; i++) {
+        decompressor->slots[i] = malloc(DECOMPRESS_CHUNK_SIZE);
+    }
+    if (pthread_create(&decompressor->thread, NULL, inflate_chunks, decompressor) != 0) {
+        for (int i = 0; i < DECOMPRESS_SLOTS; i++) free(decompressor->slots[i]);
+        free_inflater(&decompressor->inflater);
+        pthread_mutex_destroy(&decompressor->lock);
+        pthread_cond_destroy(&decompressor->chunk_filled);
+        pthread_cond_destroy(&decompressor->slot_freed);
+        free(decompressor);
+        return NULL;
+    }
+    return decompressor;
+}
+
+/* decompressor_next() for runs inflated by several workers */
+static long next_run_output(Decompressor* decompressor, const char** chunk) {
+    for (;;) {
+        if (decompressor->holding) {
+            decompressor->holding = 0;
+            decompressor->run_slots[(decompressor->taken - 1) % decompressor->slot_count].ready = 0;
+            pthread_cond_broadcast(&decompressor->slot_freed);
+        }
+        if (decompressor->taken == decompressor->run_count) return 0;
+
+        size_t index = decompressor->taken;
+        RunSlot* slot = &decompressor->run_slots[index % decompressor->slot_count];
+        while (!slot->ready) {
+            pthread_cond_wait(&decompressor->chunk_filled, &decompressor->lock);
+        }
+        if (index == decompressor->failed_run) return -1;
+
+        decompressor->taken++;
+        decompressor->holding = 1;
+        /* A run may inflate to nothing, like BGZF's end-of-file block */
+        if (decompressor->runs[index].output_length > 0) {
+            *chunk = slot->data;
+            return (long)decompressor->runs[index].output_length;
+        }
+    }
+}
+
+long decompressor_next(Decompressor* decompressor, const char** chunk) {
+    pthread_mutex_lock(&decompressor->lock);
+    if (decompressor->runs) {
+        long length = next_run_output(decompressor, chunk);
+        pthread_mutex_unlock(&decompressor->lock);
+        return length;
+    }
+
+    if (decompressor->holding) {
+        decompressor->holding = 0;
+        pthread_cond_broadcast(&decompressor->slot_freed);
+    }
+    while (decompressor->taken == decompressor->filled && !decompressor->done) {
+        pthread_cond_wait(&decompressor->chunk_filled, &decompressor->lock);
+    }
+
+    long length;
+    if (decompressor->taken < decompressor->filled) {
+        size_t slot = decompressor->taken++ % DECOMPRESS_SLOTS;
+        decompressor->holding = 1;
+        *chunk = decompressor->slots[slot];
+        length = (long)decompressor->lengths[slot];
+    } else {
+        length = decompressor->done < 0 ? -1 : 0;
+    }
+    pthread_mutex_unlock(&decompressor->lock);
+    return length;
+}
+
+const char* decompressor_error(const Decompressor* decompressor) {
+    return decompressor->error;
+}
+
+void free_decompressor(Decompressor* decompressor) {
+    if (!decompressor) return;
+
+    pthread_mutex_lock(&decompressor->lock);
+    decompressor->stop = 1;
+    pthread_cond_broadcast(&decompressor->slot_freed);
+    pthread_mutex_unlock(&decompressor->lock);
+
+    if (decompressor->runs) {
+        for (int i = 0; i < decompressor->worker_count; i++) {
+            pthread_join(decompressor->workers[i], NULL);
+        }
+        for (size_t i = 0; i < decompressor->slot_count; i++) {
+            free(decompressor->run_slots[i].data);
+        }
+        free(decompressor->workers);
+        free(decompressor->run_slots);
+        free(decompressor->runs);
+    } else {
+        pthread_join(decompressor->thread, NULL);
+        for (int i = 0; i < DECOMPRESS_SLOTS; i++) free(decompressor->slots[i]);
+        free_inflater(&decompressor->inflater);
+    }
+
+    pthread_mutex_destroy(&decompressor->lock);
+    pthread_cond_destroy(&decompressor->chunk_filled);
+    pthread_cond_destroy(&decompressor->slot_freed);
+    free(decompressor);
+}
@@ -0,0 +1,58 @@
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <stddef.h>
+#include "input.h"
+
+/* Compressed inputs are recognized by their magic bytes, whatever the
+ * file is called. zstd support needs building with -DHAVE_ZSTD -lzstd. */
+typedef enum {
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,
+    COMPRESSION_ZSTD
+} Compression;
+
+Compression detect_compression(const char* data, size_t length);
+
+/* Name of a compression format for messages ("gzip") */
+const char* compression_name(Compression compression);
+
+/* Decompress a whole input into a new padded buffer, so the modes that
+ * need the document in memory can parse it in place. gzip inputs may hold
+ * several members, which are decompressed one after another. If every
+ * member records its compressed size in its header, as the blocks of BGZF
+ * do, runs of members are inflated on up to threads threads, each straight
+ * to its place in the buffer. Returns NULL and copies a message into error
+ * if the data is damaged or the format is not supported. The compressed
+ * input is left open. */
+InputBuffer* decompress_input(const InputBuffer* input, Compression compression, int threads,
+                              char* error, size_t error_size);
+
+/* Decompression on its own thread, a few chunks ahead of the reader, so a
+ * parser consuming the chunks runs while the next ones are inflated.
+ * Memory stays bounded by DECOMPRESS_SLOTS chunks of DECOMPRESS_CHUNK_SIZE
+ * bytes. Members that record their sizes are instead inflated by up to
+ * threads workers, a run of about DECOMPRESS_CHUNK_SIZE bytes of output
+ * each, with two runs per worker in hand; the reader still gets the
+ * output in order. */
+#define DECOMPRESS_CHUNK_SIZE (1024 * 1024)
+#define DECOMPRESS_SLOTS 4
+
+typedef struct Decompressor Decompressor;
+
+/* Start decompressing data[0, length), which must stay valid until the
+ * decompressor is freed. Returns NULL if the thread cannot be started. */
+Decompressor* start_decompressor(const char* data, size_t length, Compression compression,
+                                 int threads);
+
+/* Wait for the next chunk of output. The chunk stays valid until the next
+ * call. Returns its length, 0 at the end of the data, or -1 with a message
+ * in decompressor_error() if the data is damaged. */
+long decompressor_next(Decompressor* decompressor, const char** chunk);
+
+const char* decompressor_error(const Decompressor* decompressor);
+
+/* Stop the thread, even if output is left, and release the chunks */
+void free_decompressor(Decompressor* decompressor);
+
+#endif /* DECOMPRESS_H */
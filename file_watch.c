@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+#include "file_watch.h"
+
+/* Longest wait, so a caller notices signals and files replaced under it */
+#define WATCH_TIMEOUT_MS 1000
+
+struct FileWatch {
+    int fd;                 /* inotify instance, or -1 when polling */
+};
+
+FileWatch* watch_file(const char* path) {
+    if (access(path, R_OK) != 0) return NULL;
+
+    FileWatch* watch = malloc(sizeof(FileWatch));
+    watch->fd = -1;
+#ifdef __linux__
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd >= 0 &&
+        inotify_add_watch(watch->fd, path, IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                           IN_MOVE_SELF | IN_DELETE_SELF) < 0) {
+        close(watch->fd);
+        watch->fd = -1;
+    }
+#endif
+    return watch;
+}
+
+int wait_for_change(FileWatch* watch) {
+#ifdef __linux__
+    if (watch->fd >= 0) {
+        struct pollfd poller = { watch->fd, POLLIN, 0 };
+        int ready = poll(&poller, 1, WATCH_TIMEOUT_MS);
+        if (ready < 0) return errno == EINTR ? 0 : -1;
+        if (ready == 0) return 0;
+
+        /* Drain the queue; one look at the file covers every event in it */
+        char events[4096];
+        int changed = 0;
+        ssize_t length;
+        while ((length = read(watch->fd, events, sizeof(events))) > 0) {
+            for (char* p = events; p < events + length; ) {
+                struct inotify_event* event = (struct inotify_event*)p;
+                if (event->mask & IN_IGNORED) return -1;  /* The watch is gone */
+                changed = 1;
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+#endif
+    /* Nothing tells us when the file is written, so look every time */
+    usleep(WATCH_TIMEOUT_MS * 1000);
+    return 1;
+}
+
+const char* file_watch_backend(const FileWatch* watch) {
+    return watch->fd >= 0 ? "inotify" : "polling";
+}
+
+void close_file_watch(FileWatch* watch) {
+    if (!watch) return;
+    if (watch->fd >= 0) close(watch->fd);
+    free(watch);
+}
@@ -0,0 +1,24 @@
+#ifndef FILE_WATCH_H
+#define FILE_WATCH_H
+
+/* Waits for a file to be appended to, so that --follow converts new
+ * records as they arrive instead of rereading the file on a timer. On
+ * Linux the file is watched with inotify; elsewhere, or if inotify is not
+ * available, it is checked once a second. */
+typedef struct FileWatch FileWatch;
+
+/* Start watching path. Returns NULL if it cannot be watched. */
+FileWatch* watch_file(const char* path);
+
+/* Wait up to about a second for the file to be written, moved or
+ * deleted. Returns 1 if it may have changed, 0 if not, or -1 if it can no
+ * longer be watched. A signal ends the wait early, returning 0, so the
+ * caller can check for it. */
+int wait_for_change(FileWatch* watch);
+
+/* "inotify" or "polling", for messages */
+const char* file_watch_backend(const FileWatch* watch);
+
+void close_file_watch(FileWatch* watch);
+
+#endif /* FILE_WATCH_H */
@@ -0,0 +1,179 @@
+#ifdef __linux__
+#define _GNU_SOURCE  /* mremap(), F_SETPIPE_SZ */
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include "input.h"
+
+#ifndef _WIN32
+/* Map a regular file followed by INPUT_PADDING zero bytes */
+static int map_file(InputBuffer* input, int fd, size_t length) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t total = (length + INPUT_PADDING + page - 1) / page * page;
+
+    /* Reserve zero-filled pages for data plus padding, then map the file over
+     * the front of the reservation. The tail of the last file page and any
+     * page after it read as zero, so the padding never touches the file. */
+    char* base = mmap(NULL, total, PROT_READ,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return 0;
+    }
+
+    if (length > 0 &&
+        mmap(base, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, total);
+        return 0;
+    }
+
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    input->data = base;
+    input->length = length;
+    input->mapped = total;
+    return 1;
+}
+#endif
+
+/* Grow a read buffer to hold at least capacity bytes plus the padding,
+ * updating capacity to what it holds. On Linux the buffer is page-aligned
+ * anonymous memory that mremap() can move without copying it, so reading
+ * a large stream costs no realloc() copies. */
+static char* grow_buffer(char* data, size_t* capacity, size_t* mapped) {
+#ifdef __linux__
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t total = (*capacity + INPUT_PADDING + page - 1) / page * page;
+    char* grown = *mapped ? mremap(data, *mapped, total, MREMAP_MAYMOVE)
+                          : mmap(NULL, total, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (grown == MAP_FAILED) return NULL;
+    *mapped = total;
+    *capacity = total - INPUT_PADDING;
+    return grown;
+#else
+    return realloc(data, *capacity + INPUT_PADDING);
+#endif
+}
+
+static void free_buffer(char* data, size_t mapped) {
+#ifdef __linux__
+    if (mapped) {
+        munmap(data, mapped);
+        return;
+    }
+#endif
+    free(data);
+}
+
+/* Read everything from fd into a padded buffer, read_size bytes at a time */
+static int read_file(InputBuffer* input, int fd, size_t read_size) {
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+    /* A larger pipe lets the writer run further ahead and makes each read
+     * return more; the kernel may refuse or cap the size */
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode)) {
+        fcntl(fd, F_SETPIPE_SZ, (int)(read_size < (1 << 30) ? read_size : (1 << 30)));
+    }
+#endif
+
+    size_t capacity = read_size > (1 << 20) ? read_size : (1 << 20);
+    size_t length = 0;
+    size_t mapped = 0;
+    char* data = grow_buffer(NULL, &capacity, &mapped);
+    if (!data) return 0;
+
+    for (;;) {
+        if (capacity - length < read_size) {
+            size_t wanted = capacity * 2;
+            if (wanted < length + read_size) wanted = length + read_size;
+            capacity = wanted;
+            char* grown = grow_buffer(data, &capacity, &mapped);
+            if (!grown) {
+                free_buffer(data, mapped);
+                return 0;
+            }
+            data = grown;
+        }
+
+        ssize_t n = read(fd, data + length, read_size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            free_buffer(data, mapped);
+            return 0;
+        }
+        if (n == 0) break;
+        length += (size_t)n;
+    }
+
+    memset(data + length, 0, INPUT_PADDING);
+    input->data = data;
+    input->length = length;
+    input->mapped = mapped;
+    return 1;
+}
+
+/* Load a whole input file */
+InputBuffer* open_input(const char* path) {
+    return open_input_read_size(path, INPUT_READ_SIZE);
+}
+
+InputBuffer* open_input_read_size(const char* path, size_t read_size) {
+    int from_stdin = strcmp(path, "-") == 0;
+    int fd = from_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    InputBuffer* input = malloc(sizeof(InputBuffer));
+    if (!input) {
+        if (!from_stdin) close(fd);
+        return NULL;
+    }
+
+    int ok = 0;
+    struct stat st;
+#ifndef _WIN32
+    /* A redirected file is mapped too, unless it is no longer at its start */
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+        (!from_stdin || lseek(fd, 0, SEEK_CUR) == 0)) {
+        ok = map_file(input, fd, (size_t)st.st_size);
+    }
+#endif
+    if (!ok) {
+        /* Pipes, devices, or a failed mapping */
+        ok = read_file(input, fd, read_size > 0 ? read_size : INPUT_READ_SIZE);
+    }
+    if (!from_stdin) close(fd);
+
+    if (!ok) {
+        fprintf(stderr, "Error reading '%s': %s\n", from_stdin ? "standard input" : path,
+                strerror(errno));
+        free(input);
+        return NULL;
+    }
+
+    return input;
+}
+
+/* Release the mapping or buffer */
+void close_input(InputBuffer* input) {
+    if (!input) return;
+
+#ifndef _WIN32
+    if (input->mapped) {
+        munmap(input->data, input->mapped);
+    } else
+#endif
+    {
+        free(input->data);
+    }
+    free(input);
+}
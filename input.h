@@ -0,0 +1,31 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+
+/* Number of zero bytes guaranteed to follow the input data. The structural
+ * indexer reads whole 64-byte blocks and the lexer stops token scans at
+ * the first zero byte. */
+#define INPUT_PADDING 64
+
+typedef struct {
+    char* data;        /* Input bytes, followed by INPUT_PADDING zero bytes */
+    size_t length;     /* Number of input bytes (without padding) */
+    size_t mapped;     /* Size of the mapping, 0 if data was malloc'd */
+} InputBuffer;
+
+/* Default size of each read() from a pipe or other non-regular input */
+#define INPUT_READ_SIZE (1 << 20)
+
+/* Load a whole input file, or standard input if path is "-". Regular
+ * files, redirected ones included, are memory-mapped so the scanner reads
+ * the page cache directly; anything else is read into memory. */
+InputBuffer* open_input(const char* path);
+
+/* open_input() with read_size bytes asked of each read() */
+InputBuffer* open_input_read_size(const char* path, size_t read_size);
+
+/* Release the mapping or buffer */
+void close_input(InputBuffer* input);
+
+#endif /* INPUT_H */
@@ -0,0 +1,40 @@
+#ifndef JSON_HANDLER_H
+#define JSON_HANDLER_H
+
+#include <stddef.h>
+#include "ast.h"
+
+/* Values returned by the callbacks */
+#define JSON_CONTINUE 0
+#define JSON_STOP     1  /* End the parse early; it still counts as a success */
+
+/* Also returned by key(): step over the member's value without scanning
+ * it (JSON_SKIP), or only if it is an object or array
+ * (JSON_SKIP_CONTAINER). A skipped value is found on the structural
+ * index, so nothing inside it is decoded or allocated; its brackets,
+ * commas, colons, keys, numbers and literals are checked, the contents of
+ * its strings are not. It is reported as one null scalar. */
+#define JSON_SKIP           2
+#define JSON_SKIP_CONTAINER 3
+
+/* Also returned by end_object() and end_array(): step over the remaining
+ * members or elements of the enclosing container, found in the same way,
+ * which then ends as if the one just closed were its last. */
+#define JSON_SKIP_REST      4
+
+/* Callbacks made by parse_json_events() in document order. Offsets are
+ * byte offsets into the input. Keys are interned in the parse's
+ * SymbolTable. Scalars arrive as a Node on the parser's stack whose string
+ * or number points into the input; an owned string or number (a decoded
+ * string, or any value from the push parser) is freed when the callback
+ * returns unless the handler takes it by clearing owned. */
+typedef struct {
+    int (*start_object)(void* user, size_t offset);
+    int (*end_object)(void* user);
+    int (*start_array)(void* user, size_t offset);
+    int (*end_array)(void* user);
+    int (*key)(void* user, const char* key);
+    int (*scalar)(void* user, Node* value);
+} JsonHandler;
+
+#endif /* JSON_HANDLER_H */
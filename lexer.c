@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "string_decoder.h"
+
+/* Prepare a lexer over a padded input buffer */
+void lexer_init(Lexer* lexer, const char* data, size_t length) {
+    lexer->structurals = malloc(sizeof(uint32_t) * LEXER_WINDOW);
+    lexer->error[0] = '\0';
+    lexer->partial = 0;
+    lexer->base_offset = 0;
+    lexer->base_line = 0;
+    lexer->base_column = 0;
+    lexer->start_token = 0;
+    lexer->skip = 0;
+    lexer->lines = 0;
+    lexer->line_depth = 0;
+    lexer->line_previous = SIZE_MAX;
+    lexer_reset(lexer, data, length);
+}
+
+/* The range ends at length, and stage 1 starts its first window at start */
+void lexer_init_range(Lexer* lexer, const char* data, size_t start, size_t end) {
+    lexer_init(lexer, data, end);
+    lexer->window_start = start;
+    lexer->window_end = start;
+    lexer->token_offset = start;
+}
+
+void lexer_reset(Lexer* lexer, const char* data, size_t length) {
+    lexer->data = data;
+    lexer->length = length;
+    init_index_state(&lexer->state);
+    lexer->window_start = 0;
+    lexer->window_end = 0;
+    lexer->count = 0;
+    lexer->next = 0;
+    lexer->token_offset = 0;
+}
+
+/* Release the structural index */
+void lexer_free(Lexer* lexer) {
+    free(lexer->structurals);
+    lexer->structurals = NULL;
+}
+
+/* Translate a byte offset into a 1-based line and column. Tokens and nodes
+ * only carry offsets; this is the one place lines are counted, and it only
+ * runs when a message is reported. */
+void lexer_position(const Lexer* lexer, size_t offset, size_t* line, size_t* column) {
+    if (offset > lexer->length) offset = lexer->length;
+
+    size_t line_start = offset;
+    while (line_start > 0 && lexer->data[line_start - 1] != '\n') {
+        line_start--;
+    }
+
+    *line = lexer->base_line + count_newlines(lexer->data, line_start) + 1;
+    *column = offset - line_start + 1;
+    if (line_start == 0) {
+        /* The line began before this chunk */
+        *column += lexer->base_column;
+    }
+}
+
+void lexer_report(Lexer* lexer, size_t offset, const char* message) {
+    size_t line, column;
+
+    if (lexer->error[0]) return;
+    lexer_position(lexer, offset, &line, &column);
+    snprintf(lexer->error, sizeof(lexer->error), "%s at line %zu, column %zu",
+             message, line, column);
+}
+
+static int lexer_error(Lexer* lexer, size_t offset, const char* message) {
+    lexer_report(lexer, offset, message);
+    return YYerror;
+}
+
+static int unexpected_character(Lexer* lexer, size_t offset) {
+    char message[32];
+    snprintf(message, sizeof(message), "Unexpected character '%c'", lexer->data[offset]);
+    return lexer_error(lexer, offset, message);
+}
+
+/* Run stage 1 over the next window of input */
+static int refill(Lexer* lexer) {
+    if (lexer->window_end >= lexer->length) {
+        return 0;
+    }
+
+    lexer->window_start = lexer->window_end;
+    lexer->window_end = lexer->window_start + LEXER_WINDOW;
+    if (lexer->window_end > lexer->length) {
+        lexer->window_end = lexer->length;
+    }
+
+    lexer->count = index_structurals(&lexer->state,
+                                     lexer->data + lexer->window_start,
+                                     lexer->window_end - lexer->window_start,
+                                     lexer->structurals);
+    lexer->next = 0;
+    return 1;
+}
+
+/* A bare token must be followed by whitespace, punctuation or end of input.
+ * Returns token if it is, YYerror if not. */
+static int expect_delimiter(Lexer* lexer, size_t offset, int token) {
+    if (offset >= lexer->length) return token;
+
+    switch (lexer->data[offset]) {
+        case ' ': case '\t': case '\n': case '\r':
+        case '{': case '}': case '[': case ']':
+        case ':': case ',': case '"':
+            return token;
+        default:
+            return unexpected_character(lexer, offset);
+    }
+}
+
+/* Strings without escapes are returned as views into the input; only
+ * those containing a backslash are copied and decoded. Non-ASCII bytes are
+ * validated as UTF-8 either way. */
+static int scan_string(Lexer* lexer, size_t offset, YYSTYPE* value) {
+    const char* start = lexer->data + offset + 1;
+    int flags = 0;
+
+    /* Stage 1 only records opening quotes, so find the closing one here */
+    const char* quote = scan_string_body(start, lexer->data + lexer->length, &flags);
+    if (!quote) {
+        if (lexer->partial) return LEXER_INCOMPLETE;
+        return lexer_error(lexer, offset, "Unterminated string");
+    }
+    size_t length = quote - start;
+
+    if (flags & STRING_HAS_ESCAPES) {
+        char* decoded = malloc(length + 16);
+        long decoded_length = decode_json_string(start, length, decoded);
+        if (decoded_length < 0) {
+            free(decoded);
+            return lexer_error(lexer, offset, "Invalid escape sequence or UTF-8 in string");
+        }
+        JsonString owned = { decoded, (size_t)decoded_length, 1 };
+        value->string_val = owned;
+    } else {
+        if ((flags & STRING_HAS_NON_ASCII) && !validate_utf8(start, length)) {
+            return lexer_error(lexer, offset, "Invalid UTF-8 in string");
+        }
+        JsonString view = { start, length, 0 };
+        value->string_val = view;
+    }
+    return STRING;
+}
+
+/* Whether a bare token starting at offset runs to the end of the data, so
+ * that more input could still extend it */
+static int reaches_end(const Lexer* lexer, size_t offset) {
+    for (size_t i = offset; i < lexer->length; i++) {
+        switch (lexer->data[i]) {
+            case ' ': case '\t': case '\n': case '\r':
+            case '{': case '}': case '[': case ']':
+            case ':': case ',': case '"':
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static int scan_number(Lexer* lexer, size_t offset, YYSTYPE* value) {
+    const char* data = lexer->data;
+    size_t end = offset;
+
+    if (lexer->partial && reaches_end(lexer, offset)) return LEXER_INCOMPLETE;
+
+    /* [0-9]+(\.[0-9]+)?([eE][-+]?[0-9]+)? */
+    while (data[end] >= '0' && data[end] <= '9') end++;
+    if (data[end] == '.' && data[end + 1] >= '0' && data[end + 1] <= '9') {
+        end++;
+        while (data[end] >= '0' && data[end] <= '9') end++;
+    }
+    if (data[end] == 'e' || data[end] == 'E') {
+        size_t digits = end + 1;
+        if (data[digits] == '-' || data[digits] == '+') digits++;
+        if (data[digits] >= '0' && data[digits] <= '9') {
+            end = digits;
+            while (data[end] >= '0' && data[end] <= '9') end++;
+        }
+    }
+
+    /* Keep the lexeme; it is only converted if a double is asked for */
+    JsonString lexeme = { data + offset, end - offset, 0 };
+    value->number_val = lexeme;
+    return expect_delimiter(lexer, end, NUMBER);
+}
+
+static int scan_literal(Lexer* lexer, size_t offset, const char* word, int token) {
+    size_t len = strlen(word);
+
+    if (lexer->partial && reaches_end(lexer, offset)) return LEXER_INCOMPLETE;
+
+    if (lexer->length - offset < len || memcmp(lexer->data + offset, word, len) != 0) {
+        /* Report the first byte that differs from the literal */
+        size_t i = 0;
+        while (offset + i < lexer->length && lexer->data[offset + i] == word[i]) i++;
+        return unexpected_character(lexer, offset + i);
+    }
+    return expect_delimiter(lexer, offset + len, token);
+}
+
+/* Deepest nesting stepped over; the parser's own stack holds no more */
+#define SKIP_MAX_DEPTH 10000
+
+/* What may come next while stepping over a container */
+enum {
+    EXPECT_FIRST,       /* After an open bracket: a key or value, or the close */
+    EXPECT_KEY,         /* After a comma in an object */
+    EXPECT_COLON,       /* After a key */
+    EXPECT_VALUE,       /* After a colon, or a comma in an array */
+    EXPECT_COMMA,       /* After a value: a comma or the close */
+    EXPECT_MEMBER,      /* After JSON_SKIP_REST's comma: a key or a value */
+    EXPECT_AFTER_STRING /* After a string there: a colon if it was a key */
+};
+
+/* Step over the index until the bracket that closes the container opened
+ * by open, whose offset is stored in close; open is ',' for the rest of
+ * a container of either kind. The tokens on the way must alternate as in
+ * JSON, which costs a few compares per structural, and numbers and
+ * literals are scanned in place. Strings are only matched by their
+ * quotes, so their escapes and UTF-8 are not checked.
+ * Returns 1, 0 if the data ends first, or -1 with the error reported. */
+static int match_brackets(Lexer* lexer, char open, size_t* close) {
+    uint64_t objects[(SKIP_MAX_DEPTH + 63) / 64];  /* Bit depth - 1: in an object */
+    size_t depth = 1;
+    int expect = open == ',' ? EXPECT_MEMBER : EXPECT_FIRST;
+    objects[0] = open == '{';
+
+    while (depth > 0) {
+        while (lexer->next == lexer->count) {
+            if (!refill(lexer)) return 0;
+        }
+        size_t offset = lexer->window_start + lexer->structurals[lexer->next++];
+        char c = lexer->data[offset];
+
+        /* The first member after the comma shows which kind of
+         * container the rest is in */
+        if (expect == EXPECT_MEMBER) {
+            expect = c == '"' ? EXPECT_AFTER_STRING : EXPECT_VALUE;
+            if (c == '"') continue;
+        } else if (expect == EXPECT_AFTER_STRING) {
+            objects[0] = c == ':';
+            expect = c == ':' ? EXPECT_COLON : EXPECT_COMMA;
+        }
+
+        size_t level = depth - 1;
+        int object = (objects[level / 64] >> (level % 64)) & 1;
+        int valid;
+        switch (c) {
+            case ':':
+                valid = expect == EXPECT_COLON;
+                expect = EXPECT_VALUE;
+                break;
+            case ',':
+                valid = expect == EXPECT_COMMA;
+                expect = object ? EXPECT_KEY : EXPECT_VALUE;
+                break;
+            case '}': case ']':
+                valid = (expect == EXPECT_COMMA || expect == EXPECT_FIRST) && (c == '}') == object;
+                expect = EXPECT_COMMA;
+                depth--;
+                *close = offset;
+                break;
+            case '"':
+                if (expect == EXPECT_KEY || (expect == EXPECT_FIRST && object)) {
+                    valid = 1;
+                    expect = EXPECT_COLON;
+                    break;
+                }
+                /* fall through */
+            default:
+                if (c != '"' && c != '{' && c != '[') {
+                    /* Scanned in place as the parser would, not kept */
+                    YYSTYPE scalar;
+                    int token = lexer_scan_token(lexer, offset, &scalar);
+                    if (token == LEXER_INCOMPLETE) return 0;
+                    if (token == YYerror) return -1;
+                }
+                valid = expect == EXPECT_VALUE || (expect == EXPECT_FIRST && !object);
+                expect = EXPECT_COMMA;
+                if (valid && (c == '{' || c == '[')) {
+                    if (depth == SKIP_MAX_DEPTH) {
+                        lexer_error(lexer, offset, "memory exhausted");
+                        return -1;
+                    }
+                    uint64_t bit = 1ULL << (depth % 64);
+                    objects[depth / 64] = c == '{' ? objects[depth / 64] | bit
+                                                   : objects[depth / 64] & ~bit;
+                    depth++;
+                    expect = EXPECT_FIRST;
+                }
+                break;
+        }
+        if (!valid) {
+            lexer_error(lexer, offset, "syntax error");
+            return -1;
+        }
+    }
+    return 1;
+}
+
+/* Step over the value at offset, for a handler that asked to skip it, or
+ * over the rest of the enclosing container for JSON_SKIP_REST.
+ * Containers are checked on the index alone; a string is only searched
+ * for its closing quote. In partial mode a value that may go on past the
+ * data is left, with the skip, for the next chunk. */
+static int skip_value(Lexer* lexer, size_t offset, YYSTYPE* value) {
+    int mode = lexer->skip;
+    char c = lexer->data[offset];
+    size_t close;
+
+    if (mode == JSON_SKIP_REST) {
+        lexer->skip = 0;
+        if (c != ',') return lexer_scan_token(lexer, offset, value);
+
+        int matched = match_brackets(lexer, c, &close);
+        if (matched < 0) return YYerror;
+        if (matched == 0) {
+            lexer->token_offset = offset;
+            if (lexer->partial) {
+                lexer->skip = mode;
+                return LEXER_INCOMPLETE;
+            }
+            return lexer_error(lexer, lexer->length, "syntax error");
+        }
+        /* The parser sees the container end after its last value read */
+        return lexer_scan_token(lexer, close, value);
+    }
+
+    switch (c) {
+        case ':':
+            /* The skip is for the value after the key's colon */
+            return lexer_scan_token(lexer, offset, value);
+        case ',': case '}': case ']':
+            /* Not a value: let the parser report it */
+            lexer->skip = 0;
+            return lexer_scan_token(lexer, offset, value);
+    }
+    lexer->skip = 0;
+
+    if (c == '{' || c == '[') {
+        int matched = match_brackets(lexer, c, &close);
+        if (matched < 0) return YYerror;
+        if (matched == 0) {
+            lexer->token_offset = offset;
+            if (lexer->partial) {
+                lexer->skip = mode;
+                return LEXER_INCOMPLETE;
+            }
+            return lexer_error(lexer, lexer->length, "syntax error");
+        }
+        lexer->token_offset = offset;
+        return SKIPPED;
+    }
+
+    if (mode == JSON_SKIP_CONTAINER) {
+        return lexer_scan_token(lexer, offset, value);
+    }
+
+    lexer->token_offset = offset;
+    if (c == '"') {
+        int flags = 0;
+        if (!scan_string_body(lexer->data + offset + 1, lexer->data + lexer->length, &flags)) {
+            if (lexer->partial) {
+                lexer->skip = mode;
+                return LEXER_INCOMPLETE;
+            }
+            return lexer_error(lexer, offset, "Unterminated string");
+        }
+        return SKIPPED;
+    }
+
+    /* Numbers and literals are not copied, so scanning them costs little */
+    int token = lexer_scan_token(lexer, offset, value);
+    if (token == LEXER_INCOMPLETE) {
+        lexer->skip = mode;
+        return token;
+    }
+    return token == YYerror ? token : SKIPPED;
+}
+
+/* With lines set, there may be no newline between the structurals of a
+ * value and there must be one before the next value. Only the gaps
+ * between structurals are searched, so the input is read once. The
+ * message points at the newline, so a value cut at a newline by a
+ * caller's chunking fails with the same error as a whole one. */
+static int check_line(Lexer* lexer, size_t offset) {
+    const char* data = lexer->data;
+    size_t previous = lexer->line_previous;
+    lexer->line_previous = offset;
+
+    if (lexer->line_depth > 0) {
+        const char* newline = memchr(data + previous, '\n', offset - previous);
+        if (newline) return lexer_error(lexer, newline - data, "Newline inside a record");
+    } else if (previous != SIZE_MAX && !memchr(data + previous + 1, '\n', offset - previous - 1)) {
+        return lexer_error(lexer, offset, "Expected a newline before the next record");
+    }
+
+    switch (data[offset]) {
+        case '{': case '[':
+            lexer->line_depth++;
+            break;
+        case '}': case ']':
+            if (lexer->line_depth > 0) lexer->line_depth--;
+            break;
+    }
+    return 0;
+}
+
+/* Return the next token and fill in its semantic value, 0 at end of input */
+int lexer_next(Lexer* lexer, YYSTYPE* value) {
+    if (lexer->start_token) {
+        int token = lexer->start_token;
+        lexer->start_token = 0;
+        return token;
+    }
+
+    while (lexer->next == lexer->count) {
+        if (!refill(lexer)) {
+            lexer->token_offset = lexer->length;
+            if (lexer->lines && lexer->line_depth > 0) {
+                /* A value left open at a newline: the same error as if
+                 * the rest of it had followed */
+                size_t previous = lexer->line_previous;
+                const char* newline = memchr(lexer->data + previous, '\n', lexer->length - previous);
+                if (newline) return lexer_error(lexer, newline - lexer->data, "Newline inside a record");
+            }
+            return 0;
+        }
+    }
+
+    size_t offset = lexer->window_start + lexer->structurals[lexer->next++];
+    if (lexer->lines && check_line(lexer, offset) != 0) {
+        return YYerror;
+    }
+    if (lexer->skip) {
+        return skip_value(lexer, offset, value);
+    }
+    return lexer_scan_token(lexer, offset, value);
+}
+
+/* Turn the structural at offset into a token */
+int lexer_scan_token(Lexer* lexer, size_t offset, YYSTYPE* value) {
+    lexer->token_offset = offset;
+
+    switch (lexer->data[offset]) {
+        case '{': return LBRACE;
+        case '}': return RBRACE;
+        case '[': return LBRACKET;
+        case ']': return RBRACKET;
+        case ':': return COLON;
+        case ',': return COMMA;
+        case '"': return scan_string(lexer, offset, value);
+        case 't':
+            value->boolean_val = 1;
+            return scan_literal(lexer, offset, "true", TRUE);
+        case 'f':
+            value->boolean_val = 0;
+            return scan_literal(lexer, offset, "false", FALSE);
+        case 'n':
+            return scan_literal(lexer, offset, "null", NUL);
+        default:
+            if (lexer->data[offset] >= '0' && lexer->data[offset] <= '9') {
+                return scan_number(lexer, offset, value);
+            }
+            return unexpected_character(lexer, offset);
+    }
+}
+
+int yylex(YYSTYPE* value, YYLTYPE* location, Lexer* lexer) {
+    int token = lexer_next(lexer, value);
+    *location = lexer->base_offset + lexer->token_offset;
+    return token;
+}
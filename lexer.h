@@ -0,0 +1,72 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "structural_index.h"
+#include "parser.tab.h"
+
+/* Bytes of input indexed per stage-1 pass (a multiple of 64) */
+#define LEXER_WINDOW (64 * 1024)
+
+/* Returned instead of a token by a partial lexer when the token may
+ * continue past the end of the data it has */
+#define LEXER_INCOMPLETE (-1)
+
+typedef struct Lexer {
+    const char* data;       /* Input, followed by INPUT_PADDING zero bytes */
+    size_t length;
+    IndexState state;       /* Stage-1 state carried between windows */
+    uint32_t* structurals;  /* Structural offsets, relative to window_start */
+    size_t window_start;    /* Input offset of the indexed window */
+    size_t window_end;
+    size_t count;           /* Structurals in the window */
+    size_t next;            /* Next structural to turn into a token */
+    size_t token_offset;    /* Input offset of the last token returned */
+    char error[256];        /* First error reported, empty if none */
+    int partial;            /* More input may follow data */
+    size_t base_offset;     /* Stream offset of data[0], when lexing in chunks */
+    size_t base_line;       /* Lines before data[0] */
+    size_t base_column;     /* Bytes between the last newline and data[0] */
+    int start_token;        /* Returned before the input's first token, 0 for none */
+    int skip;               /* JSON_SKIP or JSON_SKIP_CONTAINER for the next value */
+    int lines;              /* Values must be one per line, as in NDJSON */
+    size_t line_depth;      /* Containers open in the current line's value */
+    size_t line_previous;   /* Offset of the last structural, SIZE_MAX before the first */
+} Lexer;
+
+/* Prepare a lexer over a padded input buffer */
+void lexer_init(Lexer* lexer, const char* data, size_t length);
+
+/* Prepare a lexer over data[start, end) of a padded input buffer. Token
+ * offsets and error positions stay those of the whole buffer. */
+void lexer_init_range(Lexer* lexer, const char* data, size_t start, size_t end);
+
+/* Start over on new data, keeping the error, the stream position, a
+ * pending skip and the index buffer */
+void lexer_reset(Lexer* lexer, const char* data, size_t length);
+
+/* Release the structural index */
+void lexer_free(Lexer* lexer);
+
+/* Return the next token and fill in its semantic value, 0 at end of input.
+ * On a lexical error the message is stored in lexer->error and YYerror is
+ * returned, which makes the parser abort without a second message. With
+ * skip set, the next value is stepped over and returned as SKIPPED. */
+int lexer_next(Lexer* lexer, YYSTYPE* value);
+
+/* Turn the structural character at offset into a token, as lexer_next()
+ * does, for callers that walk a structural index of their own */
+int lexer_scan_token(Lexer* lexer, size_t offset, YYSTYPE* value);
+
+/* Scanner entry point for the pure parser */
+int yylex(YYSTYPE* value, YYLTYPE* location, Lexer* lexer);
+
+/* Record a message with the line and column of offset, unless an earlier
+ * error has already been recorded */
+void lexer_report(Lexer* lexer, size_t offset, const char* message);
+
+/* Translate a byte offset into a 1-based line and column */
+void lexer_position(const Lexer* lexer, size_t offset, size_t* line, size_t* column);
+
+#endif /* LEXER_H */
@@ -1,48 +1,86 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <dirent.h>
+#include <glob.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "ast.h"
 #include "csv_generator.h"
+#include "csv_ndjson.h"
+#include "csv_ondemand.h"
+#include "csv_stream.h"
+#include "decompress.h"
+#include "file_watch.h"
+#include "input.h"
+#include "parallel_parse.h"
+#include "parser.tab.h"
+#include "projection.h"
+#include "read_ahead.h"
+#include "symbol_table.h"
 
-/* External variables from parser */
-extern Node* root;
-extern FILE* yyin;
-extern int yyparse();
+/* Input bytes between checkpoints with --resume or --follow but no --checkpoint */
+#define CHECKPOINT_INTERVAL (64 << 20)
 
-int main(int argc, char** argv) {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <input.json>\n", argv[0]);
-        return 1;
-    }
-
-    printf("Opening input file: %s\n", argv[1]);
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options] [input.json | -]\n", program);
+    fprintf(stderr, "       %s --batch [options] dir/ | 'glob' | file...\n", program);
+    fprintf(stderr, "Reads standard input if the file is - or missing.\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --format-numbers   Reformat numbers with %%g instead of copying them verbatim\n");
+    fprintf(stderr, "  --stream           Write rows while parsing instead of building the whole tree first\n");
+    fprintf(stderr, "  --ondemand         Read only the values the tables use instead of building a tree\n");
+    fprintf(stderr, "  --ndjson           Read one JSON record per line (JSON Lines)\n");
+    fprintf(stderr, "  --route-key KEY    With --ndjson, name each record's table by its KEY string\n");
+    fprintf(stderr, "  --threads N        Parse (default and --ndjson modes) and inflate BGZF input on N threads\n");
+    fprintf(stderr, "  --tables LIST      Convert only these tables: root keys or paths like $.data.items[*]\n");
+    fprintf(stderr, "  --limit N          Write at most N rows to each table (or TABLE=N, comma-separated)\n");
+    fprintf(stderr, "  --read-size N[K|M] Bytes per read from a pipe (default 1M)\n");
+    fprintf(stderr, "  --read-ahead N     With --stream, keep N reads of --read-size bytes in flight\n");
+    fprintf(stderr, "  --checkpoint N     With --ndjson, save progress to output/.checkpoint every N[K|M] input bytes\n");
+    fprintf(stderr, "  --resume           With --ndjson, continue from output/.checkpoint\n");
+    fprintf(stderr, "  --follow           With --ndjson, keep converting lines as they are appended\n");
+    fprintf(stderr, "  --batch            Convert many files in one process into shared tables\n");
+}
 
-    /* Open input file */
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        fprintf(stderr, "Error: Could not open input file '%s'\n", argv[1]);
-        return 1;
+/* A byte count with an optional K or M suffix. Returns 0 if it is not one. */
+static size_t parse_size(const char* text) {
+    char* end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || text[0] == '-') return 0;
+    if (*end == 'K' || *end == 'k') {
+        value <<= 10;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        value <<= 20;
+        end++;
     }
+    return *end == '\0' && value <= (1ULL << 30) ? (size_t)value : 0;
+}
 
-    printf("Parsing JSON...\n");
-
-    /* Parse JSON */
-    if (yyparse() != 0) {
-        fprintf(stderr, "Error: Failed to parse JSON\n");
-        fclose(yyin);
-        return 1;
-    }
-    fclose(yyin);
-
-    if (!root) {
-        fprintf(stderr, "Error: No valid JSON data found\n");
-        return 1;
+/* Parse a document into the tree the CSV generator reads. Without a
+ * selection, a root object without arrays is wrapped into a one-element
+ * "users" array, so that it is written as a table. */
+static Node* parse_tree(InputBuffer* input, SymbolTable* symbols, int threads,
+                        const TableSelection* selection, const RowLimits* limits,
+                        char* error, size_t error_size) {
+    /* One thread skips what the generator will not read; more build the
+     * whole tree, split across them */
+    Node* root;
+    if (threads > 1) {
+        root = parse_json_parallel(input->data, input->length, symbols, threads,
+                                   error, error_size);
+    } else {
+        root = parse_json_projected(input->data, input->length, symbols, selection, limits,
+                                    error, error_size);
     }
 
     // --- Begin: Support single object root by wrapping in 'users' array ---
-    if (root && root->type == NODE_OBJECT) {
+    /* With --tables, only the selected values are tables */
+    if (root && root->type == NODE_OBJECT && !selection) {
         int is_collection_root = 0;
-        for (int i = 0; i < root->data.object.pair_count; i++) {
+        for (size_t i = 0; i < root->data.object.pair_count; i++) {
             Node* val = root->data.object.pairs[i]->value;
             if (val->type == NODE_ARRAY) {
                 is_collection_root = 1;
@@ -52,13 +90,684 @@ int main(int argc, char** argv) {
         if (!is_collection_root) {
             Node* arr = create_array_node(NULL, 0);
             add_element_to_array(arr, root);
-            Pair* p = create_pair_node(strdup("users"), arr);
+            Pair* p = create_pair_node(intern_key(symbols, "users", strlen("users")), arr);
             Node* new_root = create_object_node(NULL, 0);
             add_pair_to_object(new_root, p);
             root = new_root;
         }
     }
     // --- End: Support single object root by wrapping in 'users' array ---
+    return root;
+}
+
+/* Add the files a --batch argument names: the regular files of a
+ * directory, but not hidden ones; the matches of a glob pattern; or the
+ * file itself. Directory entries are sorted by name, as glob() sorts
+ * matches, so ids are given out in a repeatable order. */
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static void add_batch_files(const char* argument, char*** files, size_t* count) {
+    struct stat st;
+    size_t first = *count;
+
+    if (stat(argument, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(argument);
+        struct dirent* entry;
+        size_t length = strlen(argument);
+        const char* separator = length > 0 && argument[length - 1] == '/' ? "" : "/";
+        while (dir && (entry = readdir(dir))) {
+            if (entry->d_name[0] == '.') continue;
+
+            char path[4096];
+            snprintf(path, sizeof(path), "%s%s%s", argument, separator, entry->d_name);
+            if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            *files = realloc(*files, (*count + 1) * sizeof(char*));
+            (*files)[(*count)++] = strdup(path);
+        }
+        if (dir) closedir(dir);
+        qsort(*files + first, *count - first, sizeof(char*), compare_paths);
+    } else if (strpbrk(argument, "*?[")) {
+        glob_t matches;
+        if (glob(argument, 0, NULL, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; i++) {
+                if (stat(matches.gl_pathv[i], &st) != 0 || !S_ISREG(st.st_mode)) continue;
+                *files = realloc(*files, (*count + 1) * sizeof(char*));
+                (*files)[(*count)++] = strdup(matches.gl_pathv[i]);
+            }
+        }
+        globfree(&matches);
+    } else {
+        *files = realloc(*files, (*count + 1) * sizeof(char*));
+        (*files)[(*count)++] = strdup(argument);
+    }
+}
+
+/* Convert one file of a batch; returns 0, or -1 with a message in error */
+static int convert_batch_file(const char* path, size_t read_size, int threads,
+                              SymbolTable* symbols, const TableSelection* selection,
+                              CSVContext* context, char* error, size_t error_size) {
+    InputBuffer* input = open_input_read_size(path, read_size);
+    if (!input) {
+        snprintf(error, error_size, "Could not open input file");
+        return -1;
+    }
+
+    Compression compression = detect_compression(input->data, input->length);
+    if (compression != COMPRESSION_NONE) {
+        InputBuffer* decompressed = decompress_input(input, compression, threads, error, error_size);
+        close_input(input);
+        if (!decompressed) return -1;
+        input = decompressed;
+    }
+
+    Node* root = parse_tree(input, symbols, threads, selection, NULL, error, error_size);
+    Schema* schema = root ? analyze_ast(root) : NULL;
+    if (root && !schema) snprintf(error, error_size, "Failed to analyze AST");
+    if (schema) generate_csv(root, schema, context);
+
+    int status = schema ? 0 : -1;
+    if (schema) free_schema(schema);
+    free_ast(root);
+    close_input(input);
+    return status;
+}
+
+/* Convert many files in one process. Keys are interned once for all of
+ * them, and each table's file is opened once and stays open, so the rows
+ * of every file go to one file per table, with ids running on from file
+ * to file. A file that cannot be converted is reported and skipped. */
+static int convert_batch(const char** arguments, size_t argument_count, size_t read_size,
+                         int threads, const char* tables, int format_numbers) {
+    char** files = NULL;
+    size_t file_count = 0;
+    for (size_t i = 0; i < argument_count; i++) {
+        add_batch_files(arguments[i], &files, &file_count);
+    }
+    if (file_count == 0) {
+        fprintf(stderr, "Error: No input files found\n");
+        free(files);
+        return 1;
+    }
+
+    char error[256];
+    SymbolTable* symbols = create_symbol_table();
+    TableSelection* selection = NULL;
+    if (tables) {
+        selection = parse_table_selection(tables, symbols, error, sizeof(error));
+        if (!selection) {
+            fprintf(stderr, "Error: %s\n", error);
+            free_symbol_table(symbols);
+            for (size_t i = 0; i < file_count; i++) free(files[i]);
+            free(files);
+            return 1;
+        }
+    }
+
+    printf("Initializing CSV context...\n");
+    CSVContext* context = init_csv_context("output");
+    size_t failed = 0;
+    if (!context) {
+        fprintf(stderr, "Error: Failed to initialize CSV context\n");
+        failed = file_count;
+    } else {
+        context->format_numbers = format_numbers;
+        context->keep_files_open = 1;
+
+        printf("Converting %zu files...\n", file_count);
+        for (size_t i = 0; i < file_count; i++) {
+            if (convert_batch_file(files[i], read_size, threads, symbols, selection,
+                                   context, error, sizeof(error)) != 0) {
+                fprintf(stderr, "Error: %s: %s\n", files[i], error);
+                failed++;
+            }
+        }
+        printf("CSV generation complete: %zu files converted, %zu failed.\n",
+               file_count - failed, failed);
+    }
+
+    free_csv_context(context);
+    free_table_selection(selection);
+    free_symbol_table(symbols);
+    for (size_t i = 0; i < file_count; i++) free(files[i]);
+    free(files);
+    return failed > 0;
+}
+
+/* Convert without an AST: the CSV generator navigates the structural index */
+static int convert_ondemand(InputBuffer* input, int format_numbers) {
+    printf("Initializing CSV context...\n");
+    CSVContext* context = init_csv_context("output");
+    if (!context) {
+        fprintf(stderr, "Error: Failed to initialize CSV context\n");
+        return 1;
+    }
+    context->format_numbers = format_numbers;
+
+    printf("Indexing JSON and generating CSV files...\n");
+
+    SymbolTable* symbols = create_symbol_table();
+    JsonDocument doc;
+    int status = open_json_document(&doc, input->data, input->length, symbols);
+    if (status == 0) {
+        status = generate_csv_ondemand(&doc, context);
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "Error: %s\n", doc.lexer.error);
+    } else {
+        printf("CSV generation complete.\n");
+    }
+
+    close_json_document(&doc);
+    free_symbol_table(symbols);
+    free_csv_context(context);
+    return status != 0;
+}
+
+/* Feed a compressed input to the push parser as a second thread inflates
+ * it, so the document is never held whole, compressed or not */
+static int parse_compressed_events(InputBuffer* input, Compression compression, int threads,
+                                   SymbolTable* symbols, const JsonHandler* handler, void* user,
+                                   char* error, size_t error_size) {
+    Decompressor* decompressor = start_decompressor(input->data, input->length, compression, threads);
+    if (!decompressor) {
+        snprintf(error, error_size, "Could not start the decompression thread");
+        return -1;
+    }
+
+    JsonPushParser* parser = create_push_parser(symbols, handler, user);
+    const char* chunk;
+    long length;
+    int status = 0;
+    while ((length = decompressor_next(decompressor, &chunk)) > 0) {
+        status = push_parser_feed(parser, chunk, (size_t)length);
+        if (status != 0) break;
+    }
+    if (status != 0) {
+        snprintf(error, error_size, "%s", push_parser_error(parser));
+    } else if (length < 0) {
+        snprintf(error, error_size, "%s", decompressor_error(decompressor));
+        status = -1;
+    } else if ((status = push_parser_finish(parser)) != 0) {
+        snprintf(error, error_size, "%s", push_parser_error(parser));
+    }
+
+    free_push_parser(parser);
+    free_decompressor(decompressor);
+    return status;
+}
+
+/* Feed the push parser from reads queued ahead of it, so parsing and
+ * disk reads overlap instead of alternating */
+static int parse_read_ahead_events(ReadAhead* reader, SymbolTable* symbols,
+                                   const JsonHandler* handler, void* user,
+                                   char* error, size_t error_size) {
+    JsonPushParser* parser = create_push_parser(symbols, handler, user);
+    const char* block;
+    long length;
+    int status = 0;
+    int first = 1;
+    while ((length = read_ahead_next(reader, &block)) > 0) {
+        if (first && detect_compression(block, (size_t)length) != COMPRESSION_NONE) {
+            snprintf(error, error_size, "--read-ahead reads uncompressed input only");
+            status = -1;
+            break;
+        }
+        first = 0;
+        status = push_parser_feed(parser, block, (size_t)length);
+        if (status != 0) {
+            snprintf(error, error_size, "%s", push_parser_error(parser));
+            break;
+        }
+    }
+    if (status == 0 && length < 0) {
+        snprintf(error, error_size, "%s", read_ahead_error(reader));
+        status = -1;
+    } else if (status == 0 && (status = push_parser_finish(parser)) != 0) {
+        snprintf(error, error_size, "%s", push_parser_error(parser));
+    }
+
+    free_push_parser(parser);
+    return status;
+}
+
+/* Convert without an AST: the CSV generator consumes parser events from
+ * the input buffer, or from reader if there is no buffer */
+static int convert_streaming(InputBuffer* input, ReadAhead* reader, Compression compression,
+                             int threads, int format_numbers) {
+    printf("Initializing CSV context...\n");
+    CSVContext* context = init_csv_context("output");
+    if (!context) {
+        fprintf(stderr, "Error: Failed to initialize CSV context\n");
+        return 1;
+    }
+    context->format_numbers = format_numbers;
+
+    printf("Parsing JSON and generating CSV files...\n");
+
+    char error[256];
+    SymbolTable* symbols = create_symbol_table();
+    CSVStream* stream = create_csv_stream(context, symbols);
+    int status;
+    if (reader) {
+        status = parse_read_ahead_events(reader, symbols, &csv_stream_handler, stream,
+                                         error, sizeof(error));
+    } else if (compression != COMPRESSION_NONE) {
+        status = parse_compressed_events(input, compression, threads, symbols, &csv_stream_handler,
+                                         stream, error, sizeof(error));
+    } else {
+        status = parse_json_events(input->data, input->length, symbols,
+                                   &csv_stream_handler, stream, error, sizeof(error));
+    }
+    finish_csv_stream(stream);
+
+    if (status != 0) {
+        fprintf(stderr, "Error: %s\n", error);
+    } else {
+        printf("CSV generation complete.\n");
+    }
+
+    free_csv_stream(stream);
+    free_symbol_table(symbols);
+    free_csv_context(context);
+    return status != 0;
+}
+
+/* Records without a route go to a table named after the input file, or
+ * "stdin" */
+static void ndjson_table_name(const char* input_path, char* table_name, size_t size) {
+    const char* base = strrchr(input_path, '/');
+    base = base ? base + 1 : input_path;
+    if (strcmp(base, "-") == 0) base = "stdin";
+    snprintf(table_name, size, "%s", base);
+    char* extension = strrchr(table_name, '.');
+    if (extension && extension != table_name &&
+        (strcmp(extension, ".gz") == 0 || strcmp(extension, ".zst") == 0)) {
+        *extension = '\0';  /* events.ndjson.gz */
+        extension = strrchr(table_name, '.');
+    }
+    if (extension && extension != table_name) *extension = '\0';
+}
+
+/* Convert newline-delimited records, written as each chunk of lines is parsed */
+static int convert_ndjson(InputBuffer* input, const char* input_path, const char* route_key,
+                          int threads, const RowLimits* limits, int format_numbers,
+                          size_t checkpoint_interval, int resume) {
+    printf("Initializing CSV context...\n");
+    CSVContext* context = init_csv_context("output");
+    if (!context) {
+        fprintf(stderr, "Error: Failed to initialize CSV context\n");
+        return 1;
+    }
+    context->format_numbers = format_numbers;
+    context->limits = limits;
+
+    char table_name[256];
+    ndjson_table_name(input_path, table_name, sizeof(table_name));
+
+    char error[256];
+    char checkpoint_path[512];
+    size_t start = 0;
+    int status = 0;
+    SymbolTable* symbols = create_symbol_table();
+    NdjsonWriter* writer = create_ndjson_writer(context, symbols, table_name, route_key);
+    snprintf(checkpoint_path, sizeof(checkpoint_path), "%s/.checkpoint", context->output_dir);
+    if (checkpoint_interval > 0) {
+        set_ndjson_checkpoints(writer, checkpoint_path, checkpoint_interval);
+    }
+
+    /* The checkpoint must fall on a line of this input */
+    if (resume) {
+        status = resume_ndjson_checkpoint(writer, checkpoint_path, &start, error, sizeof(error));
+        if (status == 0 && (start > input->length || (start > 0 && input->data[start - 1] != '\n'))) {
+            snprintf(error, sizeof(error), "Checkpoint offset %zu is not a line start in this input", start);
+            status = -1;
+        }
+        if (status == 0) printf("Resuming from input offset %zu\n", start);
+    }
+
+    if (status == 0) {
+        printf("Parsing JSON lines and generating CSV files...\n");
+        status = parse_json_lines(input->data, start, input->length, symbols, threads,
+                                  write_ndjson_records, writer, error, sizeof(error));
+
+        /* After an invalid chunk, keep the rows before it; once finished,
+         * there is nothing left to resume */
+        if (checkpoint_interval > 0) {
+            if (status != 0) {
+                save_ndjson_checkpoint(writer);
+            } else {
+                remove(checkpoint_path);
+            }
+        }
+    }
+    free_ndjson_writer(writer);
+
+    if (status != 0) {
+        fprintf(stderr, "Error: %s\n", error);
+    } else {
+        printf("CSV generation complete.\n");
+    }
+
+    free_symbol_table(symbols);
+    free_csv_context(context);
+    return status != 0;
+}
+
+static volatile sig_atomic_t follow_stopped = 0;
+
+static void stop_following(int signal_number) {
+    (void)signal_number;
+    follow_stopped = 1;
+}
+
+/* Convert the complete lines of input_path, then each batch of lines
+ * appended to it, until interrupted. The checkpoint is the state file:
+ * it is saved after every batch and picked up again by the next run. */
+static int follow_ndjson(const char* input_path, const char* route_key, int threads,
+                         int format_numbers, size_t checkpoint_interval) {
+    printf("Initializing CSV context...\n");
+    CSVContext* context = init_csv_context("output");
+    if (!context) {
+        fprintf(stderr, "Error: Failed to initialize CSV context\n");
+        return 1;
+    }
+    context->format_numbers = format_numbers;
+
+    char table_name[256];
+    ndjson_table_name(input_path, table_name, sizeof(table_name));
+
+    char error[256];
+    char checkpoint_path[512];
+    size_t start = 0;
+    int status = 0;
+    SymbolTable* symbols = create_symbol_table();
+    NdjsonWriter* writer = create_ndjson_writer(context, symbols, table_name, route_key);
+    snprintf(checkpoint_path, sizeof(checkpoint_path), "%s/.checkpoint", context->output_dir);
+    set_ndjson_checkpoints(writer, checkpoint_path, checkpoint_interval);
+
+    if (access(checkpoint_path, F_OK) == 0) {
+        status = resume_ndjson_checkpoint(writer, checkpoint_path, &start, error, sizeof(error));
+        if (status == 0) printf("Resuming from input offset %zu\n", start);
+    }
+
+    FileWatch* watch = NULL;
+    if (status == 0 && !(watch = watch_file(input_path))) {
+        snprintf(error, sizeof(error), "Could not watch %s", input_path);
+        status = -1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_following;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    if (status == 0) {
+        printf("Following %s with %s; interrupt to stop\n", input_path, file_watch_backend(watch));
+    }
+
+    while (status == 0 && !follow_stopped) {
+        struct stat st;
+        if (stat(input_path, &st) != 0) {
+            snprintf(error, sizeof(error), "Could not read %s", input_path);
+            status = -1;
+            break;
+        }
+        if ((size_t)st.st_size < start) {
+            snprintf(error, sizeof(error), "%s is shorter than the %zu bytes already converted",
+                     input_path, start);
+            status = -1;
+            break;
+        }
+
+        /* Convert up to the last complete line; a partial one waits */
+        if ((size_t)st.st_size > start) {
+            InputBuffer* input = open_input(input_path);
+            if (!input) {
+                snprintf(error, sizeof(error), "Could not open input file '%s'", input_path);
+                status = -1;
+                break;
+            }
+            size_t end = input->length;
+            while (end > start && input->data[end - 1] != '\n') end--;
+
+            if (start == 0 && detect_compression(input->data, input->length) != COMPRESSION_NONE) {
+                snprintf(error, sizeof(error), "--follow reads uncompressed input only");
+                status = -1;
+            } else if (end > start) {
+                status = parse_json_lines(input->data, start, end, symbols, threads,
+                                          write_ndjson_records, writer, error, sizeof(error));
+                if (status == 0) start = end;
+                if (save_ndjson_checkpoint(writer) != 0) {
+                    fprintf(stderr, "Warning: Could not write checkpoint %s\n", checkpoint_path);
+                }
+            }
+            close_input(input);
+        }
+
+        if (status == 0 && !follow_stopped && wait_for_change(watch) < 0) {
+            snprintf(error, sizeof(error), "%s can no longer be watched", input_path);
+            status = -1;
+        }
+    }
+
+    close_file_watch(watch);
+    free_ndjson_writer(writer);
+
+    if (status != 0) {
+        fprintf(stderr, "Error: %s\n", error);
+    } else {
+        printf("Stopped at input offset %zu.\n", start);
+    }
+
+    free_symbol_table(symbols);
+    free_csv_context(context);
+    return status != 0;
+}
+
+int main(int argc, char** argv) {
+    const char* input_path = NULL;
+    int format_numbers = 0;
+    int stream = 0;
+    int ondemand = 0;
+    int ndjson = 0;
+    const char* route_key = NULL;
+    int threads = 1;
+    const char* tables = NULL;
+    const char* limit = NULL;
+    size_t read_size = INPUT_READ_SIZE;
+    int read_ahead = 0;
+    size_t checkpoint_interval = 0;
+    int resume = 0;
+    int follow = 0;
+    int batch = 0;
+    const char* paths[argc > 0 ? argc : 1];
+    size_t path_count = 0;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--format-numbers") == 0) {
+            format_numbers = 1;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = 1;
+        } else if (strcmp(argv[i], "--ondemand") == 0) {
+            ondemand = 1;
+        } else if (strcmp(argv[i], "--ndjson") == 0) {
+            ndjson = 1;
+        } else if (strcmp(argv[i], "--route-key") == 0 && i + 1 < argc) {
+            route_key = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 1) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--tables") == 0 && i + 1 < argc) {
+            tables = argv[++i];
+        } else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            limit = argv[++i];
+        } else if (strcmp(argv[i], "--read-size") == 0 && i + 1 < argc) {
+            read_size = parse_size(argv[++i]);
+            if (read_size == 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--read-ahead") == 0 && i + 1 < argc) {
+            read_ahead = atoi(argv[++i]);
+            if (read_ahead < 1) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint_interval = parse_size(argv[++i]);
+            if (checkpoint_interval == 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            resume = 1;
+        } else if (strcmp(argv[i], "--follow") == 0) {
+            follow = 1;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            paths[path_count++] = argv[i];
+        }
+    }
+
+    /* Every file of a batch goes through the default mode */
+    if (batch) {
+        if (path_count == 0 || stream + ondemand + ndjson > 0 || (tables && threads > 1) ||
+            limit || read_ahead || checkpoint_interval || resume || follow) {
+            usage(argv[0]);
+            return 1;
+        }
+        return convert_batch(paths, path_count, read_size, threads, tables, format_numbers);
+    }
+    if (path_count > 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (path_count == 1) input_path = paths[0];
+
+    /* Without a file, read a pipe or redirect, but not a terminal */
+    if (!input_path && !isatty(STDIN_FILENO)) {
+        input_path = "-";
+    }
+    if (!input_path || stream + ondemand + ndjson > 1 || (route_key && !ndjson) ||
+        (tables && threads > 1) || (tables && stream + ondemand + ndjson > 0) ||
+        (limit && (stream || ondemand || (!ndjson && threads > 1))) || (read_ahead && !stream) ||
+        ((checkpoint_interval || resume || follow) && !ndjson) ||
+        (follow && (resume || limit || strcmp(input_path, "-") == 0))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    char error[256];
+    RowLimits* limits = NULL;
+    if (limit) {
+        limits = parse_row_limits(limit, error, sizeof(error));
+        if (!limits) {
+            fprintf(stderr, "Error: %s\n", error);
+            return 1;
+        }
+    }
+
+    if (strcmp(input_path, "-") == 0) {
+        printf("Reading standard input\n");
+    } else {
+        printf("Opening input file: %s\n", input_path);
+    }
+
+    /* The file is reopened as it grows, instead of read once */
+    if (follow) {
+        if (checkpoint_interval == 0) checkpoint_interval = CHECKPOINT_INTERVAL;
+        return follow_ndjson(input_path, route_key, threads, format_numbers, checkpoint_interval);
+    }
+
+    /* The file is read in blocks as the parse goes, instead of mapped */
+    if (read_ahead) {
+        ReadAhead* reader = open_read_ahead(input_path, read_size, read_ahead);
+        if (!reader) {
+            fprintf(stderr, "Error: Could not open input file '%s'\n", input_path);
+            return 1;
+        }
+        int status = convert_streaming(NULL, reader, COMPRESSION_NONE, threads, format_numbers);
+        close_read_ahead(reader);
+        return status;
+    }
+
+    /* Open input file */
+    InputBuffer* input = open_input_read_size(input_path, read_size);
+    if (!input) {
+        fprintf(stderr, "Error: Could not open input file '%s'\n", input_path);
+        free_row_limits(limits);
+        return 1;
+    }
+
+    /* Compressed input is inflated into memory, except with --stream,
+     * which parses it while it is being inflated */
+    Compression compression = detect_compression(input->data, input->length);
+    if (compression != COMPRESSION_NONE && !stream) {
+        printf("Decompressing %s input...\n", compression_name(compression));
+        InputBuffer* decompressed = decompress_input(input, compression, threads, error, sizeof(error));
+        close_input(input);
+        if (!decompressed) {
+            fprintf(stderr, "Error: %s\n", error);
+            free_row_limits(limits);
+            return 1;
+        }
+        input = decompressed;
+    }
+
+    if (ndjson) {
+        if (resume && checkpoint_interval == 0) checkpoint_interval = CHECKPOINT_INTERVAL;
+        int status = convert_ndjson(input, input_path, route_key, threads, limits, format_numbers,
+                                    checkpoint_interval, resume);
+        free_row_limits(limits);
+        close_input(input);
+        return status;
+    }
+
+    if (stream || ondemand) {
+        int status = stream ? convert_streaming(input, NULL, compression, threads, format_numbers)
+                            : convert_ondemand(input, format_numbers);
+        close_input(input);
+        return status;
+    }
+
+    printf("Parsing JSON...\n");
+
+    /* Parse JSON directly from the input buffer */
+    SymbolTable* symbols = create_symbol_table();
+    TableSelection* selection = NULL;
+    if (tables) {
+        selection = parse_table_selection(tables, symbols, error, sizeof(error));
+        if (!selection) {
+            fprintf(stderr, "Error: %s\n", error);
+            free_row_limits(limits);
+            free_symbol_table(symbols);
+            close_input(input);
+            return 1;
+        }
+    }
+
+    Node* root = parse_tree(input, symbols, threads, selection, limits, error, sizeof(error));
+    free_table_selection(selection);
+
+    /* String nodes point into the input, so it stays open until the AST is freed */
+    if (!root) {
+        fprintf(stderr, "Error: %s\n", error);
+        free_row_limits(limits);
+        free_symbol_table(symbols);
+        close_input(input);
+        return 1;
+    }
 
     printf("JSON parsed successfully. Analyzing AST...\n");
 
@@ -67,10 +776,16 @@ int main(int argc, char** argv) {
     if (!schema) {
         fprintf(stderr, "Error: Failed to analyze AST\n");
         free_ast(root);
+        free_row_limits(limits);
+        free_symbol_table(symbols);
+        close_input(input);
         return 1;
     }
 
-    printf("AST analyzed. Schema created with %d tables.\n", schema->table_count);
+    printf("AST analyzed. Schema created with %zu tables.\n", schema->table_count);
+    if (tables && schema->table_count == 0) {
+        fprintf(stderr, "Warning: no table matches '%s'\n", tables);
+    }
 
     /* Initialize CSV context */
     printf("Initializing CSV context...\n");
@@ -79,8 +794,13 @@ int main(int argc, char** argv) {
         fprintf(stderr, "Error: Failed to initialize CSV context\n");
         free_schema(schema);
         free_ast(root);
+        free_row_limits(limits);
+        free_symbol_table(symbols);
+        close_input(input);
         return 1;
     }
+    context->format_numbers = format_numbers;
+    context->limits = limits;
 
     printf("Generating CSV files...\n");
 
@@ -91,8 +811,11 @@ int main(int argc, char** argv) {
 
     /* Cleanup */
     free_csv_context(context);
+    free_row_limits(limits);
     free_schema(schema);
     free_ast(root);
+    free_symbol_table(symbols);
+    close_input(input);
 
     return 0;
 } 
\ No newline at end of file
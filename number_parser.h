@@ -0,0 +1,12 @@
+#ifndef NUMBER_PARSER_H
+#define NUMBER_PARSER_H
+
+#include <stddef.h>
+
+/* Convert a JSON number lexeme to the nearest double. Not locale-aware and
+ * needs no NUL terminator. Up to 19 significant digits are converted with
+ * Clinger's fast path or the Eisel-Lemire algorithm; anything those cannot
+ * round exactly falls back to strtod. */
+double parse_number(const char* text, size_t length);
+
+#endif /* NUMBER_PARSER_H */
@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ondemand.h"
+
+/* Offset of the structural at position: the index holds the low 32 bits,
+ * and each 4 GB boundary the position is past adds the next 4 GB */
+static inline size_t structural_offset(const JsonDocument* doc, size_t position) {
+    size_t offset = doc->index[position];
+    for (size_t k = 0; k < doc->segment_count && doc->segments[k] <= position; k++) {
+        offset += (size_t)1 << 32;
+    }
+    return offset;
+}
+
+static int syntax_error(JsonDocument* doc, size_t position) {
+    size_t offset = position < doc->count ? structural_offset(doc, position) : doc->lexer.length;
+    lexer_report(&doc->lexer, offset, "syntax error");
+    return -1;
+}
+
+/* Check that brackets pair up and that there is exactly one root value */
+static int check_nesting(JsonDocument* doc) {
+    const char* data = doc->lexer.data;
+    char* open = NULL;
+    size_t depth = 0, capacity = 0;
+
+    if (doc->count == 0) return syntax_error(doc, 0);
+
+    for (size_t i = 0; i < doc->count; i++) {
+        char c = data[structural_offset(doc, i)];
+
+        /* Anything after a complete root value */
+        if (depth == 0 && i > 0) {
+            free(open);
+            return syntax_error(doc, i);
+        }
+
+        if (c == '{' || c == '[') {
+            if (depth == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                open = realloc(open, capacity);
+            }
+            open[depth++] = c;
+        } else if (c == '}' || c == ']') {
+            /* '[' + 2 == ']' and '{' + 2 == '}' */
+            if (depth == 0 || open[depth - 1] + 2 != c) {
+                free(open);
+                return syntax_error(doc, i);
+            }
+            depth--;
+        }
+    }
+
+    free(open);
+    return depth == 0 ? 0 : syntax_error(doc, doc->count);
+}
+
+int open_json_document(JsonDocument* doc, const char* data, size_t length, SymbolTable* symbols) {
+    Lexer* lexer = &doc->lexer;
+    size_t capacity = 0;
+
+    lexer_init(lexer, data, length);
+    doc->index = NULL;
+    doc->count = 0;
+    doc->segments = NULL;
+    doc->segment_count = 0;
+    doc->symbols = symbols;
+
+    /* Stage 1 one window at a time, the lexer's buffer holding each window */
+    for (size_t start = 0; start < length; start += LEXER_WINDOW) {
+        size_t end = start + LEXER_WINDOW < length ? start + LEXER_WINDOW : length;
+        size_t found = index_structurals(&lexer->state, data + start, end - start,
+                                         lexer->structurals);
+
+        if (doc->count + found > capacity) {
+            while (doc->count + found > capacity) {
+                capacity = capacity ? capacity * 2 : LEXER_WINDOW;
+            }
+            doc->index = realloc(doc->index, capacity * sizeof(uint32_t));
+        }
+        for (size_t i = 0; i < found; i++) {
+            size_t offset = start + lexer->structurals[i];
+
+            /* Offsets grow, so each 4 GB boundary is crossed once; a
+             * segment without structurals records the same position */
+            while ((offset >> 32) > doc->segment_count) {
+                doc->segments = realloc(doc->segments, (doc->segment_count + 1) * sizeof(size_t));
+                doc->segments[doc->segment_count++] = doc->count;
+            }
+            doc->index[doc->count++] = (uint32_t)offset;
+        }
+    }
+
+    return check_nesting(doc);
+}
+
+void close_json_document(JsonDocument* doc) {
+    lexer_free(&doc->lexer);
+    free(doc->index);
+    free(doc->segments);
+    doc->index = NULL;
+    doc->segments = NULL;
+    doc->segment_count = 0;
+}
+
+JsonValue json_document_root(const JsonDocument* doc) {
+    (void)doc;
+    return 0;
+}
+
+int json_value_type(JsonDocument* doc, JsonValue value) {
+    if (value >= doc->count) return syntax_error(doc, value);
+
+    char c = doc->lexer.data[structural_offset(doc, value)];
+    switch (c) {
+        case '{': return NODE_OBJECT;
+        case '[': return NODE_ARRAY;
+        case '"': return NODE_STRING;
+        case 't': case 'f': return NODE_BOOLEAN;
+        case 'n': return NODE_NULL;
+        default:
+            if (c >= '0' && c <= '9') return NODE_NUMBER;
+            return syntax_error(doc, value);
+    }
+}
+
+size_t json_skip_value(const JsonDocument* doc, JsonValue value) {
+    const char* data = doc->lexer.data;
+
+    if (value >= doc->count) return doc->count;
+
+    char c = data[structural_offset(doc, value)];
+    if (c != '{' && c != '[') return value + 1;
+
+    /* Nesting was checked on open, so only the depth needs tracking */
+    size_t depth = 1, position = value + 1;
+    while (depth > 0 && position < doc->count) {
+        c = data[structural_offset(doc, position++)];
+        if (c == '{' || c == '[') depth++;
+        else if (c == '}' || c == ']') depth--;
+    }
+    return position;
+}
+
+int json_value_scalar(JsonDocument* doc, JsonValue value, Node* out) {
+    YYSTYPE token_value;
+
+    if (value >= doc->count) return syntax_error(doc, value);
+
+    size_t offset = structural_offset(doc, value);
+    out->offset = offset;
+    switch (lexer_scan_token(&doc->lexer, offset, &token_value)) {
+        case STRING:
+            out->type = NODE_STRING;
+            out->data.string = token_value.string_val;
+            return 0;
+        case NUMBER:
+            out->type = NODE_NUMBER;
+            out->data.number = token_value.number_val;
+            return 0;
+        case TRUE:
+        case FALSE:
+            out->type = NODE_BOOLEAN;
+            out->data.boolean_value = token_value.boolean_val;
+            return 0;
+        case NUL:
+            out->type = NODE_NULL;
+            return 0;
+        case YYerror:
+            return -1;
+        default:
+            return syntax_error(doc, value);
+    }
+}
+
+/* A member's value may not start with punctuation */
+static int check_value_start(JsonDocument* doc, size_t position) {
+    if (position >= doc->count) return syntax_error(doc, position);
+
+    switch (doc->lexer.data[structural_offset(doc, position)]) {
+        case ',': case ':': case '}': case ']':
+            return syntax_error(doc, position);
+        default:
+            return 0;
+    }
+}
+
+/* Start iterating over a container whose opening bracket is at value */
+static int iterate(JsonDocument* doc, JsonValue value, char bracket, JsonIterator* it) {
+    if (value >= doc->count || doc->lexer.data[structural_offset(doc, value)] != bracket) {
+        return syntax_error(doc, value);
+    }
+    it->doc = doc;
+    it->position = value + 1;
+    it->started = 0;
+    return 0;
+}
+
+/* Step over the ',' before the next member, or the closing bracket.
+ * Returns 1 if a member follows. */
+static int next_member(JsonIterator* it, char bracket) {
+    JsonDocument* doc = it->doc;
+
+    if (it->position >= doc->count) return syntax_error(doc, it->position);
+
+    char c = doc->lexer.data[structural_offset(doc, it->position)];
+    if (c == bracket) {
+        it->position++;
+        return 0;
+    }
+    if (it->started) {
+        if (c != ',') return syntax_error(doc, it->position);
+        it->position++;
+    }
+    it->started = 1;
+    return 1;
+}
+
+int json_object_iterate(JsonDocument* doc, JsonValue object, JsonIterator* it) {
+    return iterate(doc, object, '{', it);
+}
+
+int json_object_next(JsonIterator* it, const char** key, JsonValue* value) {
+    JsonDocument* doc = it->doc;
+    YYSTYPE token_value;
+
+    int status = next_member(it, '}');
+    if (status <= 0) return status;
+
+    size_t position = it->position;
+    if (position >= doc->count) return syntax_error(doc, position);
+
+    int token = lexer_scan_token(&doc->lexer, structural_offset(doc, position), &token_value);
+    if (token != STRING) {
+        return token == YYerror ? -1 : syntax_error(doc, position);
+    }
+    JsonString name = token_value.string_val;
+    *key = intern_key(doc->symbols, name.chars, name.length);
+    if (name.owned) free((char*)name.chars);
+
+    position++;
+    if (position >= doc->count || doc->lexer.data[structural_offset(doc, position)] != ':') {
+        return syntax_error(doc, position);
+    }
+    position++;
+    if (check_value_start(doc, position) != 0) return -1;
+
+    *value = position;
+    it->position = json_skip_value(doc, position);
+    return 1;
+}
+
+int json_array_iterate(JsonDocument* doc, JsonValue array, JsonIterator* it) {
+    return iterate(doc, array, '[', it);
+}
+
+int json_array_next(JsonIterator* it, JsonValue* element) {
+    JsonDocument* doc = it->doc;
+
+    int status = next_member(it, ']');
+    if (status <= 0) return status;
+
+    if (check_value_start(doc, it->position) != 0) return -1;
+    *element = it->position;
+    it->position = json_skip_value(doc, it->position);
+    return 1;
+}
@@ -0,0 +1,67 @@
+#ifndef ONDEMAND_H
+#define ONDEMAND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+#include "lexer.h"
+#include "symbol_table.h"
+
+/* On-demand access to a document, after simdjson's ondemand API. Stage 1
+ * indexes the whole document up front; after that a value is only scanned
+ * when it is asked for, and everything else is stepped over by bracket
+ * matching on the index, without looking at string contents or
+ * allocating. Bracket nesting is checked for the whole document when it is
+ * opened, but scalars and object syntax are only checked where they are
+ * read. The index keeps the low 32 bits of each offset, to stay half the
+ * size; the positions where offsets cross each 4 GB boundary are kept
+ * alongside to restore the rest. */
+typedef struct {
+    Lexer lexer;            /* Scans the tokens that are read; holds the error */
+    uint32_t* index;        /* Offset of every structural character, mod 4 GB */
+    size_t count;
+    size_t* segments;       /* First position at or past each 4 GB boundary */
+    size_t segment_count;
+    SymbolTable* symbols;   /* Keys are interned here */
+} JsonDocument;
+
+/* A value is named by the position of its first structural in the index */
+typedef size_t JsonValue;
+
+typedef struct {
+    JsonDocument* doc;
+    size_t position;        /* Next structural to read */
+    int started;            /* A member has been read */
+} JsonIterator;
+
+/* Index a padded document (see input.h). Returns 0, or -1 with a message
+ * in doc->lexer.error. The document must be closed either way. */
+int open_json_document(JsonDocument* doc, const char* data, size_t length, SymbolTable* symbols);
+void close_json_document(JsonDocument* doc);
+
+/* The root value */
+JsonValue json_document_root(const JsonDocument* doc);
+
+/* Type of a value from its first byte, or -1 (with an error) if no value
+ * starts there */
+int json_value_type(JsonDocument* doc, JsonValue value);
+
+/* Position just past a value, found by bracket matching */
+size_t json_skip_value(const JsonDocument* doc, JsonValue value);
+
+/* Scan a scalar into a Node, as a parser event would carry it: strings and
+ * numbers point into the input, and a decoded string (owned set) must be
+ * freed by the caller. Returns 0, or -1 with an error. */
+int json_value_scalar(JsonDocument* doc, JsonValue value, Node* out);
+
+/* Iterate over the members of an object. json_object_next() returns 1 with
+ * the interned key and the position of its value, 0 after the last member,
+ * or -1 with an error. Values the caller does not read are skipped. */
+int json_object_iterate(JsonDocument* doc, JsonValue object, JsonIterator* it);
+int json_object_next(JsonIterator* it, const char** key, JsonValue* value);
+
+/* Iterate over the elements of an array, with the same return values */
+int json_array_iterate(JsonDocument* doc, JsonValue array, JsonIterator* it);
+int json_array_next(JsonIterator* it, JsonValue* element);
+
+#endif /* ONDEMAND_H */
@@ -0,0 +1,494 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "parallel_parse.h"
+#include "parser.tab.h"
+
+/* Arrays are cut into runs of about length / (threads * SLICES_PER_THREAD)
+ * bytes, so threads that finish early can take more work, but not smaller
+ * than MIN_SLICE_SIZE, so small documents do not pay for many parses */
+#define SLICES_PER_THREAD 8
+#define MIN_SLICE_SIZE (256 * 1024)
+
+typedef struct {
+    size_t start;       /* Byte range of one value, or of a run of elements */
+    size_t end;
+    RangeContent content;
+    Node* result;       /* NULL until parsed, or if the range is not valid */
+} ParseJob;
+
+typedef struct {
+    const char* key;    /* Interned in the shared table */
+    size_t offset;      /* Of the value */
+    int is_array;       /* The value is spliced from job_count runs */
+    size_t first_job;
+    size_t job_count;
+} RootMember;
+
+typedef enum {
+    EXPECT_FIRST_KEY,   /* After '{', which may be closed at once */
+    EXPECT_KEY,
+    EXPECT_COLON,
+    EXPECT_VALUE,
+    EXPECT_COMMA,       /* After a value: ',' or the closing '}' */
+    ROOT_CLOSED
+} SplitState;
+
+typedef struct {
+    const char* data;
+    size_t length;
+    SymbolTable* symbols;
+    Lexer lexer;            /* Stage-1 buffers, and the scanner for root keys */
+    size_t slice_size;
+    size_t root_offset;
+
+    /* Split state */
+    SplitState state;
+    size_t depth;           /* 1 inside the root object */
+    size_t run_start;       /* First byte of the current run of elements */
+    int need_start;         /* The next structural starts a run */
+    size_t scalar_start;    /* Of a member scalar waiting for its end */
+    int scalar_pending;
+
+    RootMember* members;
+    size_t member_count;
+    size_t member_capacity;
+    ParseJob* jobs;
+    size_t job_count;
+    size_t job_capacity;
+
+    size_t next_job;        /* Claimed by workers with an atomic add */
+    int failed;
+} ParallelParse;
+
+static void add_job(ParallelParse* parse, size_t start, size_t end, RangeContent content) {
+    if (parse->job_count == parse->job_capacity) {
+        parse->job_capacity = parse->job_capacity ? parse->job_capacity * 2 : 64;
+        parse->jobs = realloc(parse->jobs, parse->job_capacity * sizeof(ParseJob));
+    }
+    ParseJob* job = &parse->jobs[parse->job_count++];
+    job->start = start;
+    job->end = end;
+    job->content = content;
+    job->result = NULL;
+
+    parse->members[parse->member_count - 1].job_count++;
+}
+
+static void add_member(ParallelParse* parse, const char* key, size_t offset, int is_array) {
+    if (parse->member_count == parse->member_capacity) {
+        parse->member_capacity = parse->member_capacity ? parse->member_capacity * 2 : 16;
+        parse->members = realloc(parse->members, parse->member_capacity * sizeof(RootMember));
+    }
+    RootMember* member = &parse->members[parse->member_count++];
+    member->key = key;
+    member->offset = offset;
+    member->is_array = is_array;
+    member->first_job = parse->job_count;
+    member->job_count = 0;
+}
+
+/* Follow the root object's syntax through one structural. Values below
+ * the root's members are only tracked by depth; their parses check them.
+ * Returns 0, or -1 if the root is not an object or is malformed. */
+static int split_structural(ParallelParse* parse, size_t offset) {
+    char c = parse->data[offset];
+
+    if (parse->depth == 0) {
+        if (parse->state != EXPECT_FIRST_KEY || c != '{') return -1;
+        parse->root_offset = offset;
+        parse->depth = 1;
+        return 0;
+    }
+
+    if (parse->depth > 1) {
+        RootMember* member = &parse->members[parse->member_count - 1];
+
+        if (parse->need_start && parse->depth == 2 && c != ']') {
+            parse->run_start = offset;
+            parse->need_start = 0;
+        }
+
+        if (c == '{' || c == '[') {
+            parse->depth++;
+        } else if (c == '}' || c == ']') {
+            if (--parse->depth > 1) return 0;
+
+            if (!member->is_array) {
+                if (c != '}') return -1;
+                add_job(parse, member->offset, offset + 1, RANGE_VALUE);
+            } else {
+                if (c != ']') return -1;
+                if (!parse->need_start) {
+                    add_job(parse, parse->run_start, offset, RANGE_ELEMENTS);
+                } else if (member->job_count > 0) {
+                    return -1;  /* A comma before ']' */
+                }
+            }
+            parse->state = EXPECT_COMMA;
+        } else if (c == ',' && parse->depth == 2 && member->is_array &&
+                   offset - parse->run_start >= parse->slice_size) {
+            add_job(parse, parse->run_start, offset, RANGE_ELEMENTS);
+            parse->need_start = 1;
+        }
+        return 0;
+    }
+
+    switch (parse->state) {
+        case EXPECT_FIRST_KEY:
+        case EXPECT_KEY: {
+            if (c == '}' && parse->state == EXPECT_FIRST_KEY) {
+                parse->depth = 0;
+                parse->state = ROOT_CLOSED;
+                return 0;
+            }
+            YYSTYPE value;
+            if (c != '"' || lexer_scan_token(&parse->lexer, offset, &value) != STRING) return -1;
+
+            JsonString name = value.string_val;
+            add_member(parse, intern_key(parse->symbols, name.chars, name.length), 0, 0);
+            if (name.owned) free((char*)name.chars);
+            parse->state = EXPECT_COLON;
+            return 0;
+        }
+
+        case EXPECT_COLON:
+            if (c != ':') return -1;
+            parse->state = EXPECT_VALUE;
+            return 0;
+
+        case EXPECT_VALUE: {
+            RootMember* member = &parse->members[parse->member_count - 1];
+            if (c == ',' || c == ':' || c == '}' || c == ']') return -1;
+
+            member->offset = offset;
+            if (c == '{' || c == '[') {
+                member->is_array = c == '[';
+                parse->need_start = 1;
+                parse->run_start = offset + 1;
+                parse->depth = 2;
+            } else {
+                parse->scalar_start = offset;
+                parse->scalar_pending = 1;
+                parse->state = EXPECT_COMMA;
+            }
+            return 0;
+        }
+
+        case EXPECT_COMMA:
+            if (c != ',' && c != '}') return -1;
+            if (parse->scalar_pending) {
+                add_job(parse, parse->scalar_start, offset, RANGE_VALUE);
+                parse->scalar_pending = 0;
+            }
+            if (c == ',') {
+                parse->state = EXPECT_KEY;
+            } else {
+                parse->depth = 0;
+                parse->state = ROOT_CLOSED;
+            }
+            return 0;
+
+        default:
+            return -1;  /* Anything after the root */
+    }
+}
+
+/* Run stage 1 over the document one window at a time, as the lexer does */
+static int split_document(ParallelParse* parse) {
+    Lexer* lexer = &parse->lexer;
+
+    for (size_t start = 0; start < parse->length; start += LEXER_WINDOW) {
+        size_t end = start + LEXER_WINDOW < parse->length ? start + LEXER_WINDOW : parse->length;
+        size_t found = index_structurals(&lexer->state, parse->data + start, end - start,
+                                         lexer->structurals);
+
+        for (size_t i = 0; i < found; i++) {
+            if (split_structural(parse, start + lexer->structurals[i]) != 0) return -1;
+        }
+    }
+    return parse->state == ROOT_CLOSED ? 0 : -1;
+}
+
+static void* parse_jobs(void* arg) {
+    ParallelParse* parse = arg;
+    SymbolTable* symbols = create_local_symbol_table(parse->symbols);
+    char error[256];
+
+    for (;;) {
+        size_t i = __atomic_fetch_add(&parse->next_job, 1, __ATOMIC_RELAXED);
+        if (i >= parse->job_count || __atomic_load_n(&parse->failed, __ATOMIC_RELAXED)) break;
+
+        ParseJob* job = &parse->jobs[i];
+        job->result = parse_json_range(parse->data, job->start, job->end, job->content,
+                                       symbols, error, sizeof(error));
+        if (!job->result) {
+            __atomic_store_n(&parse->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    free_symbol_table(symbols);
+    return NULL;
+}
+
+/* One array holding the elements of a member's runs, in order */
+static Node* splice_runs(ParallelParse* parse, RootMember* member) {
+    ParseJob* runs = &parse->jobs[member->first_job];
+    size_t count = 0;
+
+    for (size_t i = 0; i < member->job_count; i++) {
+        count += runs[i].result->data.array.element_count;
+    }
+
+    Node** elements = count > 0 ? malloc(count * sizeof(Node*)) : NULL;
+    size_t copied = 0;
+    for (size_t i = 0; i < member->job_count; i++) {
+        Node* run = runs[i].result;
+        memcpy(elements + copied, run->data.array.elements,
+               run->data.array.element_count * sizeof(Node*));
+        copied += run->data.array.element_count;
+        free(run->data.array.elements);
+        free(run);
+    }
+
+    Node* array = create_array_node(elements, count);
+    array->offset = member->offset;
+    return array;
+}
+
+static Node* build_root(ParallelParse* parse) {
+    Node* root = create_object_node(NULL, 0);
+    root->offset = parse->root_offset;
+
+    for (size_t i = 0; i < parse->member_count; i++) {
+        RootMember* member = &parse->members[i];
+        Node* value = member->is_array ? splice_runs(parse, member)
+                                       : parse->jobs[member->first_job].result;
+        add_pair_to_object(root, create_pair_node(member->key, value));
+    }
+    return root;
+}
+
+Node* parse_json_parallel(const char* data, size_t length, SymbolTable* symbols,
+                          int threads, char* error, size_t error_size) {
+    if (threads <= 1) {
+        return parse_json(data, length, symbols, error, error_size);
+    }
+
+    ParallelParse parse;
+    memset(&parse, 0, sizeof(parse));
+    parse.data = data;
+    parse.length = length;
+    parse.symbols = symbols;
+    parse.state = EXPECT_FIRST_KEY;
+    parse.slice_size = length / ((size_t)threads * SLICES_PER_THREAD);
+    if (parse.slice_size < MIN_SLICE_SIZE) parse.slice_size = MIN_SLICE_SIZE;
+    lexer_init(&parse.lexer, data, length);
+
+    Node* root = NULL;
+    if (split_document(&parse) == 0) {
+        size_t workers = (size_t)threads - 1;
+        if (workers > parse.job_count) workers = parse.job_count;
+
+        pthread_t* ids = malloc((workers ? workers : 1) * sizeof(pthread_t));
+        size_t started = 0;
+        while (started < workers && pthread_create(&ids[started], NULL, parse_jobs, &parse) == 0) {
+            started++;
+        }
+        parse_jobs(&parse);
+        for (size_t i = 0; i < started; i++) {
+            pthread_join(ids[i], NULL);
+        }
+        free(ids);
+
+        if (!parse.failed) {
+            root = build_root(&parse);
+        }
+    }
+
+    if (!root) {
+        /* Not an object root, or not valid: the serial parse finds the
+         * first error in document order */
+        for (size_t i = 0; i < parse.job_count; i++) {
+            free_ast(parse.jobs[i].result);
+        }
+        root = parse_json(data, length, symbols, error, error_size);
+    }
+
+    lexer_free(&parse.lexer);
+    free(parse.members);
+    free(parse.jobs);
+    return root;
+}
+
+/* Lines are parsed in chunks of at least this many bytes, ending at a
+ * newline, and each thread has up to LINE_SLOTS_PER_THREAD chunks in hand */
+#define LINE_CHUNK_SIZE (1024 * 1024)
+#define LINE_SLOTS_PER_THREAD 2
+
+typedef struct {
+    Node* records;      /* NULL if the chunk is not valid */
+    size_t end;
+    int parsed;
+    char error[256];
+} LineChunk;
+
+typedef struct {
+    const char* data;
+    size_t length;
+    SymbolTable* symbols;
+    LineChunk* slots;       /* Ring indexed by chunk number */
+    size_t slot_count;
+    size_t next_start;      /* First byte of the next chunk to claim */
+    size_t claimed;         /* Chunks claimed by workers */
+    size_t written;         /* Chunks handed to the callback */
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t chunk_parsed;
+    pthread_cond_t slot_freed;
+} LinePipeline;
+
+/* End of the chunk that starts at start: the first newline at least
+ * LINE_CHUNK_SIZE bytes on, or the end of the document */
+static size_t chunk_end(const char* data, size_t length, size_t start) {
+    if (length - start <= LINE_CHUNK_SIZE) return length;
+
+    const char* newline = memchr(data + start + LINE_CHUNK_SIZE, '\n',
+                                 length - start - LINE_CHUNK_SIZE);
+    return newline ? (size_t)(newline - data) + 1 : length;
+}
+
+static void* parse_line_chunks(void* arg) {
+    LinePipeline* pipeline = arg;
+    SymbolTable* symbols = create_local_symbol_table(pipeline->symbols);
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;) {
+        while (!pipeline->stop && pipeline->next_start < pipeline->length &&
+               pipeline->claimed - pipeline->written == pipeline->slot_count) {
+            pthread_cond_wait(&pipeline->slot_freed, &pipeline->lock);
+        }
+        if (pipeline->stop || pipeline->next_start >= pipeline->length) break;
+
+        LineChunk* chunk = &pipeline->slots[pipeline->claimed++ % pipeline->slot_count];
+        size_t start = pipeline->next_start;
+        size_t end = chunk_end(pipeline->data, pipeline->length, start);
+        pipeline->next_start = end;
+        chunk->end = end;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        chunk->records = parse_json_range(pipeline->data, start, end, RANGE_SEQUENCE,
+                                          symbols, chunk->error, sizeof(chunk->error));
+
+        pthread_mutex_lock(&pipeline->lock);
+        chunk->parsed = 1;
+        pthread_cond_broadcast(&pipeline->chunk_parsed);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+
+    free_symbol_table(symbols);
+    return NULL;
+}
+
+/* Hand the chunks to the callback in order as the workers finish them */
+static int write_line_chunks(LinePipeline* pipeline, JsonRecordsFn records, void* user,
+                             char* error, size_t error_size) {
+    int status = 0;
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;) {
+        LineChunk* chunk = &pipeline->slots[pipeline->written % pipeline->slot_count];
+        while (!(pipeline->written < pipeline->claimed && chunk->parsed) &&
+               !(pipeline->next_start >= pipeline->length && pipeline->written == pipeline->claimed)) {
+            pthread_cond_wait(&pipeline->chunk_parsed, &pipeline->lock);
+        }
+        if (pipeline->written == pipeline->claimed) break;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        int result = JSON_STOP;
+        if (chunk->records) {
+            result = records(user, chunk->records, chunk->end);
+        } else {
+            snprintf(error, error_size, "%s", chunk->error);
+            status = -1;
+        }
+        free_ast(chunk->records);
+        chunk->records = NULL;
+
+        pthread_mutex_lock(&pipeline->lock);
+        chunk->parsed = 0;
+        pipeline->written++;
+        if (result != JSON_CONTINUE) pipeline->stop = 1;
+        pthread_cond_broadcast(&pipeline->slot_freed);
+        if (pipeline->stop) break;
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return status;
+}
+
+int parse_json_lines(const char* data, size_t start, size_t length, SymbolTable* symbols,
+                     int threads, JsonRecordsFn records, void* user,
+                     char* error, size_t error_size) {
+    if (threads <= 1) {
+        while (start < length) {
+            size_t end = chunk_end(data, length, start);
+            Node* chunk = parse_json_range(data, start, end, RANGE_SEQUENCE, symbols,
+                                           error, error_size);
+            if (!chunk) return -1;
+
+            int result = records(user, chunk, end);
+            free_ast(chunk);
+            if (result != JSON_CONTINUE) break;
+            start = end;
+        }
+        return 0;
+    }
+
+    LinePipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.data = data;
+    pipeline.length = length;
+    pipeline.next_start = start;
+    pipeline.symbols = symbols;
+    pipeline.slot_count = (size_t)threads * LINE_SLOTS_PER_THREAD;
+    pipeline.slots = calloc(pipeline.slot_count, sizeof(LineChunk));
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.chunk_parsed, NULL);
+    pthread_cond_init(&pipeline.slot_freed, NULL);
+
+    pthread_t* ids = malloc(threads * sizeof(pthread_t));
+    int started = 0;
+    while (started < threads &&
+           pthread_create(&ids[started], NULL, parse_line_chunks, &pipeline) == 0) {
+        started++;
+    }
+
+    int status;
+    if (started == 0) {
+        status = parse_json_lines(data, start, length, symbols, 1, records, user,
+                                  error, error_size);
+    } else {
+        status = write_line_chunks(&pipeline, records, user, error, error_size);
+    }
+
+    /* Stop workers that are still waiting for a free slot */
+    pthread_mutex_lock(&pipeline.lock);
+    pipeline.stop = 1;
+    pthread_cond_broadcast(&pipeline.slot_freed);
+    pthread_mutex_unlock(&pipeline.lock);
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    for (size_t i = 0; i < pipeline.slot_count; i++) {
+        free_ast(pipeline.slots[i].records);
+    }
+    free(pipeline.slots);
+    free(ids);
+    pthread_cond_destroy(&pipeline.chunk_parsed);
+    pthread_cond_destroy(&pipeline.slot_freed);
+    pthread_mutex_destroy(&pipeline.lock);
+    return status;
+}
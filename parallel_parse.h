@@ -0,0 +1,40 @@
+#ifndef PARALLEL_PARSE_H
+#define PARALLEL_PARSE_H
+
+#include <stddef.h>
+#include "ast.h"
+#include "json_handler.h"
+#include "symbol_table.h"
+
+/* Parse a padded document (see input.h) into the same AST as parse_json(),
+ * using up to threads threads. When the root is an object, one serial
+ * stage-1 pass finds its members and cuts each array into runs of
+ * elements at the array's own commas. The runs and the other member
+ * values are then parsed concurrently, and the runs are spliced back in
+ * document order. Each thread interns keys through a local table in front
+ * of symbols. Any other root is parsed on the calling thread. If the input
+ * is not valid JSON, it is parsed again serially, so the message is the
+ * one parse_json() gives. */
+Node* parse_json_parallel(const char* data, size_t length, SymbolTable* symbols,
+                          int threads, char* error, size_t error_size);
+
+/* Receives the records of one chunk of lines, in an array node that is
+ * freed when it returns, and the offset just past the chunk's last line.
+ * Returns JSON_CONTINUE, or JSON_STOP to end the parse early. */
+typedef int (*JsonRecordsFn)(void* user, Node* records, size_t end);
+
+/* Parse a padded document of newline-delimited records (NDJSON / JSON
+ * Lines), from start, which must begin a line; error positions still
+ * count from the start of data. The rest is cut into chunks at newlines, each parsed as a
+ * sequence of values, one per line; a record that spans lines or shares
+ * one with another fails the same way wherever the chunks are cut. With threads > 1
+ * the chunks are parsed by that many worker threads, a few chunks ahead,
+ * while the calling thread hands them to records() in document order;
+ * workers intern keys through local tables in front of symbols. Returns
+ * 0, or -1 with a message in error for the first chunk, in document
+ * order, that is not valid. The chunks before it have been handed over. */
+int parse_json_lines(const char* data, size_t start, size_t length, SymbolTable* symbols,
+                     int threads, JsonRecordsFn records, void* user,
+                     char* error, size_t error_size);
+
+#endif /* PARALLEL_PARSE_H */
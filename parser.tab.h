@@ -1,342 +1,194 @@
-#ifndef YY_parse_h_included
-#define YY_parse_h_included
-/*#define YY_USE_CLASS 
-*/
-#line 1 "/usr/share/bison++/bison.h"
-/* before anything */
-#ifdef c_plusplus
- #ifndef __cplusplus
-  #define __cplusplus
- #endif
-#endif
-
-
- #line 8 "/usr/share/bison++/bison.h"
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_PARSER_TAB_H_INCLUDED
+# define YY_YY_PARSER_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 8 "parser.y"
+
+#include "ast.h"
+#include "json_handler.h"
+#include "symbol_table.h"
+
+struct Lexer;
+
+#line 57 "parser.tab.h"
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    STRING = 258,                  /* STRING  */
+    NUMBER = 259,                  /* NUMBER  */
+    TRUE = 260,                    /* TRUE  */
+    FALSE = 261,                   /* FALSE  */
+    LBRACE = 262,                  /* LBRACE  */
+    RBRACE = 263,                  /* RBRACE  */
+    LBRACKET = 264,                /* LBRACKET  */
+    RBRACKET = 265,                /* RBRACKET  */
+    COLON = 266,                   /* COLON  */
+    COMMA = 267,                   /* COMMA  */
+    NUL = 268,                     /* NUL  */
+    ELEMENTS_START = 269,          /* ELEMENTS_START  */
+    SEQUENCE_START = 270,          /* SEQUENCE_START  */
+    SKIPPED = 271                  /* SKIPPED  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 128 "parser.y"
 
-#line 19 "parser.y"
-typedef union {
-    char* string_val;
-    double double_val;
+    JsonString string_val;
+    JsonString number_val;
     int boolean_val;
-    struct Node* node;
-    struct Pair* pair;
-} yy_parse_stype;
-#define YY_parse_STYPE yy_parse_stype
-#ifndef YY_USE_CLASS
-#define YYSTYPE yy_parse_stype
-#endif
-
-#line 21 "/usr/share/bison++/bison.h"
- /* %{ and %header{ and %union, during decl */
-#ifndef YY_parse_COMPATIBILITY
- #ifndef YY_USE_CLASS
-  #define  YY_parse_COMPATIBILITY 1
- #else
-  #define  YY_parse_COMPATIBILITY 0
- #endif
-#endif
-
-#if YY_parse_COMPATIBILITY != 0
-/* backward compatibility */
- #ifdef YYLTYPE
-  #ifndef YY_parse_LTYPE
-   #define YY_parse_LTYPE YYLTYPE
-/* WARNING obsolete !!! user defined YYLTYPE not reported into generated header */
-/* use %define LTYPE */
-  #endif
- #endif
-/*#ifdef YYSTYPE*/
-  #ifndef YY_parse_STYPE
-   #define YY_parse_STYPE YYSTYPE
-  /* WARNING obsolete !!! user defined YYSTYPE not reported into generated header */
-   /* use %define STYPE */
-  #endif
-/*#endif*/
- #ifdef YYDEBUG
-  #ifndef YY_parse_DEBUG
-   #define  YY_parse_DEBUG YYDEBUG
-   /* WARNING obsolete !!! user defined YYDEBUG not reported into generated header */
-   /* use %define DEBUG */
-  #endif
- #endif 
- /* use goto to be compatible */
- #ifndef YY_parse_USE_GOTO
-  #define YY_parse_USE_GOTO 1
- #endif
-#endif
-
-/* use no goto to be clean in C++ */
-#ifndef YY_parse_USE_GOTO
- #define YY_parse_USE_GOTO 0
-#endif
-
-#ifndef YY_parse_PURE
 
- #line 65 "/usr/share/bison++/bison.h"
+#line 96 "parser.tab.h"
 
-#line 65 "/usr/share/bison++/bison.h"
-/* YY_parse_PURE */
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
+/* Location type.  */
+typedef size_t YYLTYPE;
 
- #line 68 "/usr/share/bison++/bison.h"
-
-#line 68 "/usr/share/bison++/bison.h"
-/* prefix */
 
-#ifndef YY_parse_DEBUG
 
- #line 71 "/usr/share/bison++/bison.h"
 
-#line 71 "/usr/share/bison++/bison.h"
-/* YY_parse_DEBUG */
+#ifndef YYPUSH_MORE_DEFINED
+# define YYPUSH_MORE_DEFINED
+enum { YYPUSH_MORE = 4 };
 #endif
 
-#ifndef YY_parse_LSP_NEEDED
+typedef struct yypstate yypstate;
 
- #line 75 "/usr/share/bison++/bison.h"
-
-#line 75 "/usr/share/bison++/bison.h"
- /* YY_parse_LSP_NEEDED*/
-#endif
 
-/* DEFAULT LTYPE*/
-#ifdef YY_parse_LSP_NEEDED
- #ifndef YY_parse_LTYPE
-  #ifndef BISON_YYLTYPE_ISDECLARED
-   #define BISON_YYLTYPE_ISDECLARED
-typedef
-  struct yyltype
-    {
-      int timestamp;
-      int first_line;
-      int first_column;
-      int last_line;
-      int last_column;
-      char *text;
-   }
-  yyltype;
-  #endif
-
-  #define YY_parse_LTYPE yyltype
- #endif
-#endif
+int yyparse (struct Lexer* lexer, SymbolTable* symbols, const JsonHandler* handler, void* user);
+int yypush_parse (yypstate *ps,
+                  int pushed_char, YYSTYPE const *pushed_val, YYLTYPE *pushed_loc, struct Lexer* lexer, SymbolTable* symbols, const JsonHandler* handler, void* user);
+int yypull_parse (yypstate *ps, struct Lexer* lexer, SymbolTable* symbols, const JsonHandler* handler, void* user);
+yypstate *yypstate_new (void);
+void yypstate_delete (yypstate *ps);
 
-/* DEFAULT STYPE*/
-#ifndef YY_parse_STYPE
- #define YY_parse_STYPE int
-#endif
+/* "%code provides" blocks.  */
+#line 16 "parser.y"
 
-/* DEFAULT MISCELANEOUS */
-#ifndef YY_parse_PARSE
- #define YY_parse_PARSE yyparse
-#endif
+/* Parse a padded document (see input.h), reporting its structure to
+ * handler as it is recognized. Object keys are interned in symbols.
+ * Returns 0 on success, including when a callback stopped the parse, or
+ * -1 with a message copied into error if the input is not valid JSON.
+ * All parser state lives on the caller's stack, so documents may be
+ * parsed concurrently, each with its own symbol table. */
+int parse_json_events(const char* data, size_t length, SymbolTable* symbols,
+                      const JsonHandler* handler, void* user,
+                      char* error, size_t error_size);
 
-#ifndef YY_parse_LEX
- #define YY_parse_LEX yylex
-#endif
+/* Parse a padded document into an AST, built by a handler on top of
+ * parse_json_events(). Returns NULL and copies a message into error if it
+ * is not valid JSON. */
+Node* parse_json(const char* data, size_t length, SymbolTable* symbols,
+                 char* error, size_t error_size);
 
-#ifndef YY_parse_LVAL
- #define YY_parse_LVAL yylval
-#endif
+/* The tree builder behind parse_json(), for callers that filter the
+ * events before the tree is built: pass ast_builder_handler with the
+ * builder as user. finish_ast_builder() frees the builder and returns the
+ * tree, or frees that too after a failed parse. */
+typedef struct AstBuilder AstBuilder;
 
-#ifndef YY_parse_LLOC
- #define YY_parse_LLOC yylloc
-#endif
+extern const JsonHandler ast_builder_handler;
 
-#ifndef YY_parse_CHAR
- #define YY_parse_CHAR yychar
-#endif
+AstBuilder* create_ast_builder(void);
+Node* finish_ast_builder(AstBuilder* builder, int failed);
 
-#ifndef YY_parse_NERRS
- #define YY_parse_NERRS yynerrs
-#endif
+/* What a range passed to parse_json_range() holds */
+typedef enum {
+    RANGE_VALUE,        /* One value */
+    RANGE_ELEMENTS,     /* A comma-separated run of array elements */
+    RANGE_SEQUENCE      /* One value per line, as in NDJSON */
+} RangeContent;
 
-#ifndef YY_parse_DEBUG_FLAG
- #define YY_parse_DEBUG_FLAG yydebug
-#endif
+/* Parse data[start, end) of a padded document into an AST, for callers
+ * that have already split the document. A range of elements or of a
+ * sequence is returned as an array node holding its values. The range
+ * must not end inside a token. Offsets and error positions are those of
+ * the whole document. */
+Node* parse_json_range(const char* data, size_t start, size_t end, RangeContent content,
+                       SymbolTable* symbols, char* error, size_t error_size);
 
-#ifndef YY_parse_ERROR
- #define YY_parse_ERROR yyerror
-#endif
+/* Incremental parser for input that arrives in pieces. Chunks may split
+ * the document anywhere, including inside tokens, strings and UTF-8
+ * sequences; the unfinished tail of a chunk is carried into the next one.
+ * Events are the same as for parse_json_events() except that every string
+ * and number is an owned copy, since chunk buffers do not outlive the
+ * call that fed them. */
+typedef struct JsonPushParser JsonPushParser;
 
-#ifndef YY_parse_PARSE_PARAM
- #ifndef __STDC__
-  #ifndef __cplusplus
-   #ifndef YY_USE_CLASS
-    #define YY_parse_PARSE_PARAM
-    #ifndef YY_parse_PARSE_PARAM_DEF
-     #define YY_parse_PARSE_PARAM_DEF
-    #endif
-   #endif
-  #endif
- #endif
- #ifndef YY_parse_PARSE_PARAM
-  #define YY_parse_PARSE_PARAM void
- #endif
-#endif
+JsonPushParser* create_push_parser(SymbolTable* symbols, const JsonHandler* handler, void* user);
 
-/* TOKEN C */
-#ifndef YY_USE_CLASS
-
- #ifndef YY_parse_PURE
-  #ifndef yylval
-   extern YY_parse_STYPE YY_parse_LVAL;
-  #else
-   #if yylval != YY_parse_LVAL
-    extern YY_parse_STYPE YY_parse_LVAL;
-   #else
-    #warning "Namespace conflict, disabling some functionality (bison++ only)"
-   #endif
-  #endif
- #endif
-
-
- #line 169 "/usr/share/bison++/bison.h"
-#define	STRING	258
-#define	NUMBER	259
-#define	TRUE	260
-#define	FALSE	261
-#define	LBRACE	262
-#define	RBRACE	263
-#define	LBRACKET	264
-#define	RBRACKET	265
-#define	COLON	266
-#define	COMMA	267
-#define	NUL	268
-
-
-#line 169 "/usr/share/bison++/bison.h"
- /* #defines token */
-/* after #define tokens, before const tokens S5*/
-#else
- #ifndef YY_parse_CLASS
-  #define YY_parse_CLASS parse
- #endif
-
- #ifndef YY_parse_INHERIT
-  #define YY_parse_INHERIT
- #endif
-
- #ifndef YY_parse_MEMBERS
-  #define YY_parse_MEMBERS 
- #endif
-
- #ifndef YY_parse_LEX_BODY
-  #define YY_parse_LEX_BODY  
- #endif
-
- #ifndef YY_parse_ERROR_BODY
-  #define YY_parse_ERROR_BODY  
- #endif
-
- #ifndef YY_parse_CONSTRUCTOR_PARAM
-  #define YY_parse_CONSTRUCTOR_PARAM
- #endif
- /* choose between enum and const */
- #ifndef YY_parse_USE_CONST_TOKEN
-  #define YY_parse_USE_CONST_TOKEN 0
-  /* yes enum is more compatible with flex,  */
-  /* so by default we use it */ 
- #endif
- #if YY_parse_USE_CONST_TOKEN != 0
-  #ifndef YY_parse_ENUM_TOKEN
-   #define YY_parse_ENUM_TOKEN yy_parse_enum_token
-  #endif
- #endif
-
-class YY_parse_CLASS YY_parse_INHERIT
-{
-public: 
- #if YY_parse_USE_CONST_TOKEN != 0
-  /* static const int token ... */
-  
- #line 212 "/usr/share/bison++/bison.h"
-static const int STRING;
-static const int NUMBER;
-static const int TRUE;
-static const int FALSE;
-static const int LBRACE;
-static const int RBRACE;
-static const int LBRACKET;
-static const int RBRACKET;
-static const int COLON;
-static const int COMMA;
-static const int NUL;
-
-
-#line 212 "/usr/share/bison++/bison.h"
- /* decl const */
- #else
-  enum YY_parse_ENUM_TOKEN { YY_parse_NULL_TOKEN=0
-  
- #line 215 "/usr/share/bison++/bison.h"
-	,STRING=258
-	,NUMBER=259
-	,TRUE=260
-	,FALSE=261
-	,LBRACE=262
-	,RBRACE=263
-	,LBRACKET=264
-	,RBRACKET=265
-	,COLON=266
-	,COMMA=267
-	,NUL=268
-
-
-#line 215 "/usr/share/bison++/bison.h"
- /* enum token */
-     }; /* end of enum declaration */
- #endif
-public:
- int YY_parse_PARSE(YY_parse_PARSE_PARAM);
- virtual void YY_parse_ERROR(char *msg) YY_parse_ERROR_BODY;
- #ifdef YY_parse_PURE
-  #ifdef YY_parse_LSP_NEEDED
-   virtual int  YY_parse_LEX(YY_parse_STYPE *YY_parse_LVAL,YY_parse_LTYPE *YY_parse_LLOC) YY_parse_LEX_BODY;
-  #else
-   virtual int  YY_parse_LEX(YY_parse_STYPE *YY_parse_LVAL) YY_parse_LEX_BODY;
-  #endif
- #else
-  virtual int YY_parse_LEX() YY_parse_LEX_BODY;
-  YY_parse_STYPE YY_parse_LVAL;
-  #ifdef YY_parse_LSP_NEEDED
-   YY_parse_LTYPE YY_parse_LLOC;
-  #endif
-  int YY_parse_NERRS;
-  int YY_parse_CHAR;
- #endif
- #if YY_parse_DEBUG != 0
-  public:
-   int YY_parse_DEBUG_FLAG;	/*  nonzero means print parse trace	*/
- #endif
-public:
- YY_parse_CLASS(YY_parse_CONSTRUCTOR_PARAM);
-public:
- YY_parse_MEMBERS 
-};
-/* other declare folow */
-#endif
+/* Parse a chunk. Returns 0, or -1 once the input is known to be invalid.
+ * After a callback stops the parse, further chunks are ignored. */
+int push_parser_feed(JsonPushParser* parser, const char* chunk, size_t length);
 
+/* Signal the end of input. Returns 0 if the chunks formed one JSON value
+ * (or a callback stopped the parse), else -1. */
+int push_parser_finish(JsonPushParser* parser);
 
-#if YY_parse_COMPATIBILITY != 0
- /* backward compatibility */
- /* Removed due to bison problems
- /#ifndef YYSTYPE
- / #define YYSTYPE YY_parse_STYPE
- /#endif*/
+/* Message for a -1 returned by the calls above */
+const char* push_parser_error(const JsonPushParser* parser);
 
- #ifndef YYLTYPE
-  #define YYLTYPE YY_parse_LTYPE
- #endif
- #ifndef YYDEBUG
-  #ifdef YY_parse_DEBUG 
-   #define YYDEBUG YY_parse_DEBUG
-  #endif
- #endif
+void free_push_parser(JsonPushParser* parser);
 
-#endif
-/* END */
+#line 193 "parser.tab.h"
 
- #line 267 "/usr/share/bison++/bison.h"
-#endif
+#endif /* !YY_YY_PARSER_TAB_H_INCLUDED  */
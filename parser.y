@@ -3,93 +3,534 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ast.h"
+%}
 
-/* External variables from scanner */
-extern int line;
-extern int column;
-extern FILE* yyin;
+%code requires {
+#include "ast.h"
+#include "json_handler.h"
+#include "symbol_table.h"
 
-/* AST root node */
-Node* root = NULL;
+struct Lexer;
+}
 
-void yyerror(const char* s);
-extern int yylex();
-%}
+%code provides {
+/* Parse a padded document (see input.h), reporting its structure to
+ * handler as it is recognized. Object keys are interned in symbols.
+ * Returns 0 on success, including when a callback stopped the parse, or
+ * -1 with a message copied into error if the input is not valid JSON.
+ * All parser state lives on the caller's stack, so documents may be
+ * parsed concurrently, each with its own symbol table. */
+int parse_json_events(const char* data, size_t length, SymbolTable* symbols,
+                      const JsonHandler* handler, void* user,
+                      char* error, size_t error_size);
+
+/* Parse a padded document into an AST, built by a handler on top of
+ * parse_json_events(). Returns NULL and copies a message into error if it
+ * is not valid JSON. */
+Node* parse_json(const char* data, size_t length, SymbolTable* symbols,
+                 char* error, size_t error_size);
+
+/* The tree builder behind parse_json(), for callers that filter the
+ * events before the tree is built: pass ast_builder_handler with the
+ * builder as user. finish_ast_builder() frees the builder and returns the
+ * tree, or frees that too after a failed parse. */
+typedef struct AstBuilder AstBuilder;
+
+extern const JsonHandler ast_builder_handler;
+
+AstBuilder* create_ast_builder(void);
+Node* finish_ast_builder(AstBuilder* builder, int failed);
+
+/* What a range passed to parse_json_range() holds */
+typedef enum {
+    RANGE_VALUE,        /* One value */
+    RANGE_ELEMENTS,     /* A comma-separated run of array elements */
+    RANGE_SEQUENCE      /* One value per line, as in NDJSON */
+} RangeContent;
+
+/* Parse data[start, end) of a padded document into an AST, for callers
+ * that have already split the document. A range of elements or of a
+ * sequence is returned as an array node holding its values. The range
+ * must not end inside a token. Offsets and error positions are those of
+ * the whole document. */
+Node* parse_json_range(const char* data, size_t start, size_t end, RangeContent content,
+                       SymbolTable* symbols, char* error, size_t error_size);
+
+/* Incremental parser for input that arrives in pieces. Chunks may split
+ * the document anywhere, including inside tokens, strings and UTF-8
+ * sequences; the unfinished tail of a chunk is carried into the next one.
+ * Events are the same as for parse_json_events() except that every string
+ * and number is an owned copy, since chunk buffers do not outlive the
+ * call that fed them. */
+typedef struct JsonPushParser JsonPushParser;
+
+JsonPushParser* create_push_parser(SymbolTable* symbols, const JsonHandler* handler, void* user);
+
+/* Parse a chunk. Returns 0, or -1 once the input is known to be invalid.
+ * After a callback stops the parse, further chunks are ignored. */
+int push_parser_feed(JsonPushParser* parser, const char* chunk, size_t length);
+
+/* Signal the end of input. Returns 0 if the chunks formed one JSON value
+ * (or a callback stopped the parse), else -1. */
+int push_parser_finish(JsonPushParser* parser);
+
+/* Message for a -1 returned by the calls above */
+const char* push_parser_error(const JsonPushParser* parser);
+
+void free_push_parser(JsonPushParser* parser);
+}
+
+%code {
+#include "input.h"
+#include "lexer.h"
+
+void yyerror(YYLTYPE* location, struct Lexer* lexer, SymbolTable* symbols,
+             const JsonHandler* handler, void* user, const char* s);
+
+/* A value's location is the offset of its first token */
+#define YYLLOC_DEFAULT(Current, Rhs, N) \
+    ((Current) = (N) ? YYRHSLOC(Rhs, 1) : YYRHSLOC(Rhs, 0))
+
+/* Make a callback, ending the parse successfully if it asks to stop */
+#define EMIT(call) \
+    do { if ((call) != JSON_CONTINUE) YYACCEPT; } while (0)
+
+/* The end of a container may also ask to skip the rest of its parent.
+ * Its rule is reduced before the next token is read, so the lexer sees
+ * the request in time. */
+#define EMIT_END(call) \
+    do { \
+        int status_ = (call); \
+        if (status_ == JSON_SKIP_REST) lexer->skip = status_; \
+        else if (status_ != JSON_CONTINUE) YYACCEPT; \
+    } while (0)
+
+/* Hand a scalar to the handler, then free its string or number if it is
+ * owned and the handler did not take it */
+static int emit_scalar(const JsonHandler* handler, void* user, Node* value) {
+    int status = handler->scalar(user, value);
+    if (value->type == NODE_STRING && value->data.string.owned) {
+        free((char*)value->data.string.chars);
+    } else if (value->type == NODE_NUMBER && value->data.number.owned) {
+        free((char*)value->data.number.chars);
+    }
+    return status;
+}
+}
+
+%define api.pure full
+%define api.push-pull both
+%locations
+%define api.location.type {size_t}
+%param {struct Lexer* lexer}
+%parse-param {SymbolTable* symbols} {const JsonHandler* handler} {void* user}
 
 %union {
-    char* string_val;
-    double double_val;
+    JsonString string_val;
+    JsonString number_val;
     int boolean_val;
-    struct Node* node;
-    struct Pair* pair;
 }
 
 %token <string_val> STRING
-%token <double_val> NUMBER
+%token <number_val> NUMBER
 %token <boolean_val> TRUE FALSE
 %token LBRACE RBRACE LBRACKET RBRACKET COLON COMMA NUL
+%token ELEMENTS_START SEQUENCE_START  /* Never in the input; see parse_json_range() */
+%token SKIPPED  /* A value a handler asked to skip; see JSON_SKIP */
 
-%type <node> json value object array members elements
-%type <pair> pair
+/* Release a decoded or copied string when a parse is abandoned */
+%destructor { if ($$.owned) free((char*)$$.chars); } <string_val> <number_val>
 
 %%
 
 json:
-    value { root = $1; }
+    value
+    | ELEMENTS_START elements
+    | SEQUENCE_START sequence
+    ;
+
+sequence:
+    %empty
+    | sequence value
     ;
 
 value:
-    object  { $$ = $1; }
-    | array { $$ = $1; }
-    | STRING { 
-        $$ = create_string_node($1);
-        free($1);  /* Free string allocated by lexer */
-    }
-    | NUMBER { $$ = create_number_node($1); }
-    | TRUE { $$ = create_boolean_node(1); }
-    | FALSE { $$ = create_boolean_node(0); }
-    | NUL { $$ = create_null_node(); }
+    object
+    | array
+    | STRING {
+        Node node = { .type = NODE_STRING, .offset = @1, .data.string = $1 };
+        EMIT(emit_scalar(handler, user, &node));
+    }
+    | NUMBER {
+        Node node = { .type = NODE_NUMBER, .offset = @1, .data.number = $1 };
+        EMIT(emit_scalar(handler, user, &node));
+    }
+    | TRUE {
+        Node node = { .type = NODE_BOOLEAN, .offset = @1, .data.boolean_value = 1 };
+        EMIT(emit_scalar(handler, user, &node));
+    }
+    | FALSE {
+        Node node = { .type = NODE_BOOLEAN, .offset = @1, .data.boolean_value = 0 };
+        EMIT(emit_scalar(handler, user, &node));
+    }
+    | NUL {
+        Node node = { .type = NODE_NULL, .offset = @1 };
+        EMIT(emit_scalar(handler, user, &node));
+    }
+    | SKIPPED {
+        Node node = { .type = NODE_NULL, .offset = @1 };
+        EMIT(emit_scalar(handler, user, &node));
+    }
     ;
 
 object:
-    LBRACE RBRACE { $$ = create_object_node(NULL, 0); }
-    | LBRACE members RBRACE { $$ = $2; }
+    object_start RBRACE { EMIT_END(handler->end_object(user)); }
+    | object_start members RBRACE { EMIT_END(handler->end_object(user)); }
+    ;
+
+object_start:
+    LBRACE { EMIT(handler->start_object(user, @1)); }
     ;
 
 members:
-    pair { 
-        $$ = create_object_node(NULL, 0);
-        add_pair_to_object($$, $1);
-    }
-    | members COMMA pair { 
-        $$ = $1;
-        add_pair_to_object($$, $3);
-    }
+    pair
+    | members COMMA pair
     ;
 
 pair:
-    STRING COLON value { $$ = create_pair_node($1, $3); free($1); }
+    key COLON value
+    ;
+
+key:
+    STRING {
+        const char* key = intern_key(symbols, $1.chars, $1.length);
+        if ($1.owned) free((char*)$1.chars);  /* Free string decoded by lexer */
+        int status = handler->key(user, key);
+        if (status == JSON_SKIP || status == JSON_SKIP_CONTAINER) {
+            lexer->skip = status;
+        } else {
+            EMIT(status);
+        }
+    }
     ;
 
 array:
-    LBRACKET RBRACKET { $$ = create_array_node(NULL, 0); }
-    | LBRACKET elements RBRACKET { $$ = $2; }
+    array_start RBRACKET { EMIT_END(handler->end_array(user)); }
+    | array_start elements RBRACKET { EMIT_END(handler->end_array(user)); }
+    ;
+
+array_start:
+    LBRACKET { EMIT(handler->start_array(user, @1)); }
     ;
 
 elements:
-    value { 
-        $$ = create_array_node(NULL, 0);
-        add_element_to_array($$, $1);
-    }
-    | elements COMMA value {
-        $$ = $1;
-        add_element_to_array($$, $3);
-    }
+    value
+    | elements COMMA value
     ;
 
 %%
 
-void yyerror(const char* s) {
-    fprintf(stderr, "Error: %s at line %d, column %d\n", s, line, column);
-    exit(1);
-}
\ No newline at end of file
+void yyerror(YYLTYPE* location, struct Lexer* lexer, SymbolTable* symbols,
+             const JsonHandler* handler, void* user, const char* s) {
+    (void)symbols;
+    (void)handler;
+    (void)user;
+    lexer_report(lexer, *location - lexer->base_offset, s);
+}
+
+/* Run a pull parse over a prepared lexer, then release it */
+static int run_parser(Lexer* lexer, SymbolTable* symbols, const JsonHandler* handler,
+                      void* user, char* error, size_t error_size) {
+    int status = yyparse(lexer, symbols, handler, user);
+    if (status != 0) {
+        snprintf(error, error_size, "%s", lexer->error[0] ? lexer->error : "Failed to parse JSON");
+    }
+    lexer_free(lexer);
+    return status == 0 ? 0 : -1;
+}
+
+int parse_json_events(const char* data, size_t length, SymbolTable* symbols,
+                      const JsonHandler* handler, void* user,
+                      char* error, size_t error_size) {
+    Lexer lexer;
+
+    lexer_init(&lexer, data, length);
+    return run_parser(&lexer, symbols, handler, user, error, error_size);
+}
+
+/* Tree building handler: containers are linked into their parent as soon
+ * as they start, so a failed parse leaves one tree that free_ast() can
+ * release from the root. */
+struct AstBuilder {
+    Node* root;
+    Node** stack;        /* Open containers, innermost last */
+    int depth;
+    int capacity;
+    const char* key;     /* Key of the next value in the innermost object */
+};
+
+static void attach_node(AstBuilder* builder, Node* node) {
+    if (builder->depth == 0) {
+        builder->root = node;
+        return;
+    }
+
+    Node* parent = builder->stack[builder->depth - 1];
+    if (parent->type == NODE_OBJECT) {
+        add_pair_to_object(parent, create_pair_node(builder->key, node));
+    } else {
+        add_element_to_array(parent, node);
+    }
+}
+
+static int open_container(AstBuilder* builder, Node* node, size_t offset) {
+    node->offset = offset;
+    attach_node(builder, node);
+
+    if (builder->depth == builder->capacity) {
+        builder->capacity = builder->capacity ? builder->capacity * 2 : 16;
+        builder->stack = realloc(builder->stack, builder->capacity * sizeof(Node*));
+    }
+    builder->stack[builder->depth++] = node;
+    return JSON_CONTINUE;
+}
+
+static int close_container(void* user) {
+    ((AstBuilder*)user)->depth--;
+    return JSON_CONTINUE;
+}
+
+static int build_start_object(void* user, size_t offset) {
+    return open_container(user, create_object_node(NULL, 0), offset);
+}
+
+static int build_start_array(void* user, size_t offset) {
+    return open_container(user, create_array_node(NULL, 0), offset);
+}
+
+static int build_key(void* user, const char* key) {
+    ((AstBuilder*)user)->key = key;
+    return JSON_CONTINUE;
+}
+
+static int build_scalar(void* user, Node* value) {
+    Node* node;
+
+    switch (value->type) {
+        case NODE_STRING:
+            node = create_string_node(value->data.string);
+            value->data.string.owned = 0;  /* The node owns it now */
+            break;
+        case NODE_NUMBER:
+            node = create_number_node(value->data.number);
+            value->data.number.owned = 0;
+            break;
+        case NODE_BOOLEAN:
+            node = create_boolean_node(value->data.boolean_value);
+            break;
+        default:
+            node = create_null_node();
+            break;
+    }
+    node->offset = value->offset;
+    attach_node(user, node);
+    return JSON_CONTINUE;
+}
+
+const JsonHandler ast_builder_handler = {
+    build_start_object,
+    close_container,
+    build_start_array,
+    close_container,
+    build_key,
+    build_scalar
+};
+
+AstBuilder* create_ast_builder(void) {
+    return calloc(1, sizeof(AstBuilder));
+}
+
+Node* finish_ast_builder(AstBuilder* builder, int failed) {
+    Node* root = builder->root;
+
+    if (failed) {
+        free_ast(root);
+        root = NULL;
+    }
+    free(builder->stack);
+    free(builder);
+    return root;
+}
+
+/* Build the tree for a prepared lexer. A container given as the root
+ * starts out open, so the values parsed are added to it. */
+static Node* build_ast(Lexer* lexer, Node* container, SymbolTable* symbols,
+                       char* error, size_t error_size) {
+    AstBuilder builder = { NULL, NULL, 0, 0, NULL };
+
+    if (container) {
+        open_container(&builder, container, container->offset);
+    }
+    if (run_parser(lexer, symbols, &ast_builder_handler, &builder, error, error_size) != 0) {
+        free_ast(builder.root);
+        builder.root = NULL;
+    }
+    free(builder.stack);
+    return builder.root;
+}
+
+Node* parse_json(const char* data, size_t length, SymbolTable* symbols,
+                 char* error, size_t error_size) {
+    Lexer lexer;
+
+    lexer_init(&lexer, data, length);
+    return build_ast(&lexer, NULL, symbols, error, error_size);
+}
+
+Node* parse_json_range(const char* data, size_t start, size_t end, RangeContent content,
+                       SymbolTable* symbols, char* error, size_t error_size) {
+    Lexer lexer;
+    Node* container = NULL;
+
+    lexer_init_range(&lexer, data, start, end);
+    if (content != RANGE_VALUE) {
+        lexer.start_token = content == RANGE_ELEMENTS ? ELEMENTS_START : SEQUENCE_START;
+        lexer.lines = content == RANGE_SEQUENCE;
+        container = create_array_node(NULL, 0);
+        container->offset = start;
+    }
+    return build_ast(&lexer, container, symbols, error, error_size);
+}
+
+struct JsonPushParser {
+    yypstate* state;
+    Lexer lexer;
+    SymbolTable* symbols;
+    const JsonHandler* handler;
+    void* user;
+    char* buffer;           /* Unparsed input, followed by INPUT_PADDING zero bytes */
+    size_t length;
+    size_t capacity;
+    size_t wait_for;        /* Length to reach before lexing an unfinished token again */
+    int status;             /* YYPUSH_MORE until the parse ends */
+};
+
+JsonPushParser* create_push_parser(SymbolTable* symbols, const JsonHandler* handler, void* user) {
+    JsonPushParser* parser = malloc(sizeof(JsonPushParser));
+    parser->state = yypstate_new();
+    parser->symbols = symbols;
+    parser->handler = handler;
+    parser->user = user;
+    parser->capacity = LEXER_WINDOW;
+    parser->buffer = malloc(parser->capacity + INPUT_PADDING);
+    memset(parser->buffer, 0, INPUT_PADDING);
+    parser->length = 0;
+    parser->wait_for = 0;
+    parser->status = YYPUSH_MORE;
+    lexer_init(&parser->lexer, parser->buffer, 0);
+    return parser;
+}
+
+/* Copy a token that points into the buffer, which the next chunk reuses */
+static void own_string(JsonString* string) {
+    if (string->owned) return;
+
+    char* copy = malloc(string->length + 1);
+    memcpy(copy, string->chars, string->length);
+    copy[string->length] = '\0';
+    string->chars = copy;
+    string->owned = 1;
+}
+
+/* Pass the buffered tokens to the parser. With more input to come, a
+ * token that reaches the end of the buffer is left for the next chunk. */
+static void push_tokens(JsonPushParser* parser, int final) {
+    Lexer* lexer = &parser->lexer;
+    size_t consumed = parser->length;
+    int incomplete = 0;
+
+    lexer_reset(lexer, parser->buffer, parser->length);
+    lexer->partial = !final;
+
+    while (parser->status == YYPUSH_MORE) {
+        YYSTYPE value;
+        int token = lexer_next(lexer, &value);
+
+        if (token == LEXER_INCOMPLETE) {
+            consumed = lexer->token_offset;
+            incomplete = 1;
+            break;
+        }
+        if (token == YYEOF && !final) break;
+
+        if (token == STRING) own_string(&value.string_val);
+        if (token == NUMBER) own_string(&value.number_val);
+
+        YYLTYPE location = lexer->base_offset + lexer->token_offset;
+        parser->status = yypush_parse(parser->state, token, &value, &location, lexer,
+                                      parser->symbols, parser->handler, parser->user);
+    }
+    if (final) return;
+
+    /* Keep the stream position of the bytes that stay in the buffer */
+    size_t line_start = consumed;
+    while (line_start > 0 && parser->buffer[line_start - 1] != '\n') line_start--;
+    if (line_start > 0) {
+        lexer->base_line += count_newlines(parser->buffer, line_start);
+        lexer->base_column = consumed - line_start;
+    } else {
+        lexer->base_column += consumed;
+    }
+    lexer->base_offset += consumed;
+
+    parser->length -= consumed;
+    memmove(parser->buffer, parser->buffer + consumed, parser->length);
+
+    /* Rescanning a long unfinished string on every chunk would be
+     * quadratic, so wait until the tail has at least doubled */
+    parser->wait_for = incomplete ? parser->length * 2 : 0;
+}
+
+int push_parser_feed(JsonPushParser* parser, const char* chunk, size_t length) {
+    if (parser->status != YYPUSH_MORE) return parser->status == 0 ? 0 : -1;
+
+    if (parser->length + length > parser->capacity) {
+        while (parser->length + length > parser->capacity) parser->capacity *= 2;
+        parser->buffer = realloc(parser->buffer, parser->capacity + INPUT_PADDING);
+    }
+    memcpy(parser->buffer + parser->length, chunk, length);
+    parser->length += length;
+    memset(parser->buffer + parser->length, 0, INPUT_PADDING);
+
+    if (parser->length >= parser->wait_for) {
+        push_tokens(parser, 0);
+    }
+    return parser->status == YYPUSH_MORE || parser->status == 0 ? 0 : -1;
+}
+
+int push_parser_finish(JsonPushParser* parser) {
+    if (parser->status == YYPUSH_MORE) {
+        push_tokens(parser, 1);
+    }
+    return parser->status == 0 ? 0 : -1;
+}
+
+const char* push_parser_error(const JsonPushParser* parser) {
+    return parser->lexer.error[0] ? parser->lexer.error : "Failed to parse JSON";
+}
+
+void free_push_parser(JsonPushParser* parser) {
+    if (!parser) return;
+
+    /* An error token makes an unfinished parse abort, which runs the
+     * destructors for the values still on its stack */
+    if (parser->status == YYPUSH_MORE) {
+        YYLTYPE location = parser->lexer.base_offset;
+        yypush_parse(parser->state, YYerror, NULL, &location, &parser->lexer,
+                     parser->symbols, parser->handler, parser->user);
+    }
+    yypstate_delete(parser->state);
+    lexer_free(&parser->lexer);
+    free(parser->buffer);
+    free(parser);
+}
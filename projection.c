@@ -0,0 +1,723 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "parser.tab.h"
+#include "projection.h"
+
+/* A member of the root object, as the planning pass saw it */
+typedef struct {
+    const char* key;
+    char type;              /* First byte of the value */
+    int is_table;           /* An object, or an array whose first element is one */
+} PlannedMember;
+
+/* A name analyze_ast() makes a table of */
+typedef struct {
+    const char* name;
+    int definitions;        /* Root members that define it */
+    const char** columns;   /* Keys of its first row, or of its root object */
+    size_t column_count;
+    size_t column_capacity;
+    int known;              /* columns are complete */
+    long long limit;        /* Rows --limit lets through, or -1 */
+    long long rows;         /* Rows kept since the generator last opened its file */
+    int seen;               /* A root-level value of it has been read */
+    int has_rows;           /* ... that is an array of rows */
+} PlannedTable;
+
+typedef enum {
+    SCOPE_ROOT,
+    SCOPE_ROWS,             /* An array whose object elements are rows of table */
+    SCOPE_ROW,              /* An object written as a row of table */
+    SCOPE_SCHEMA,           /* A root object: only its keys are used */
+    SCOPE_PATH,             /* An object on the way to a selected value */
+    SCOPE_KEEP              /* Everything is kept (the plan did not match) */
+} ScopeKind;
+
+typedef struct {
+    ScopeKind kind;
+    PlannedTable* table;
+    const char* key;        /* ROW: key of the value being read */
+    int learning;           /* ROW, SCHEMA: the keys are table's columns */
+    int defines;            /* ROWS: the first element's keys are table's columns */
+    int first_seen;         /* ROWS */
+    int root_level;         /* ROWS: a table in its own right */
+    int level;              /* PATH: keys matched to reach it */
+} Scope;
+
+/* What to do with the value event of a skipped member */
+typedef enum {
+    PASS_VALUE,             /* Give it to the builder as it is */
+    DROP_VALUE,             /* Leave the member out of the tree */
+    EMPTY_ARRAY,            /* Keep the member as an empty array */
+    ENTER_PATH,             /* Follow a selector into the object */
+    HOIST                   /* A selected value: a table under pending_key */
+} PendingValue;
+
+typedef struct {
+    SymbolTable* symbols;
+    PlannedMember* members;
+    size_t member_count;
+    size_t member_capacity;
+    PlannedTable* tables;
+    size_t table_count;
+    size_t table_capacity;
+    const char* users;      /* The table main() wraps a root without arrays into */
+    int wrapped;
+    const TableSelection* selection;
+    const char** path;      /* Keys from the root to the current member */
+    int lazy;               /* No planning pass: members are judged as they come */
+
+    Scope* scopes;
+    int depth;
+    int scope_capacity;
+    size_t next_member;     /* Root member whose key comes next */
+    const char* member_key; /* Key of the root member being read */
+    int valid;              /* The root keys have matched the plan so far */
+    int drop_depth;         /* Depth inside a container left out of the tree */
+    PendingValue pending;
+    const char* pending_key;
+    AstBuilder* builder;
+} Projection;
+
+/* State of the planning pass */
+typedef struct {
+    size_t depth;
+    int expect_key;
+    int expect_value;
+    int check_first;        /* The next structural is the first in an array */
+    int closed;
+} PlanWalk;
+
+/* Parse one selector, spec[0, length), into path */
+static int parse_selector(const char* spec, size_t length, SymbolTable* symbols, TablePath* path) {
+    path->keys = NULL;
+    path->length = 0;
+
+    if (length == 0) return -1;
+    if (spec[0] != '$') {
+        /* A root key, taken as it is */
+        path->keys = malloc(sizeof(char*));
+        path->keys[path->length++] = intern_key(symbols, spec, length);
+        return 0;
+    }
+
+    if (length >= 3 && memcmp(spec + length - 3, "[*]", 3) == 0) length -= 3;
+    size_t i = 1;
+    while (i < length) {
+        if (spec[i] != '.') return -1;
+        size_t start = ++i;
+        while (i < length && spec[i] != '.' && spec[i] != '[' && spec[i] != ']') i++;
+        if (i == start || (i < length && spec[i] != '.')) return -1;
+
+        path->keys = realloc(path->keys, (path->length + 1) * sizeof(char*));
+        path->keys[path->length++] = intern_key(symbols, spec + start, i - start);
+    }
+    return path->length > 0 ? 0 : -1;
+}
+
+TableSelection* parse_table_selection(const char* spec, SymbolTable* symbols,
+                                      char* error, size_t error_size) {
+    TableSelection* selection = calloc(1, sizeof(TableSelection));
+
+    for (const char* start = spec;; ) {
+        const char* end = strchr(start, ',');
+        size_t length = end ? (size_t)(end - start) : strlen(start);
+
+        selection->paths = realloc(selection->paths, (selection->count + 1) * sizeof(TablePath));
+        TablePath* path = &selection->paths[selection->count++];
+        if (parse_selector(start, length, symbols, path) != 0) {
+            snprintf(error, error_size, "invalid table selector '%.*s'", (int)length, start);
+            free_table_selection(selection);
+            return NULL;
+        }
+        if (path->length > selection->max_length) selection->max_length = path->length;
+
+        if (!end) break;
+        start = end + 1;
+    }
+    return selection;
+}
+
+void free_table_selection(TableSelection* selection) {
+    if (!selection) return;
+
+    for (int i = 0; i < selection->count; i++) {
+        free(selection->paths[i].keys);
+    }
+    free(selection->paths);
+    free(selection);
+}
+
+enum { SELECT_NONE, SELECT_PATH, SELECT_TABLE };
+
+/* SELECT_TABLE if a selector names the value at path[0, length),
+ * SELECT_PATH if one leads below it, or SELECT_NONE */
+static int select_path(const TableSelection* selection, const char* const* path, int length) {
+    int selected = SELECT_NONE;
+
+    for (int i = 0; i < selection->count; i++) {
+        const TablePath* candidate = &selection->paths[i];
+        if (candidate->length < length) continue;
+
+        int j = 0;
+        while (j < length && candidate->keys[j] == path[j]) j++;
+        if (j < length) continue;
+
+        if (candidate->length == length) return SELECT_TABLE;
+        selected = SELECT_PATH;
+    }
+    return selected;
+}
+
+static PlannedTable* find_table(Projection* projection, const char* name) {
+    for (size_t i = 0; i < projection->table_count; i++) {
+        if (projection->tables[i].name == name) return &projection->tables[i];
+    }
+    return NULL;
+}
+
+static PlannedTable* add_table(Projection* projection, const char* name) {
+    PlannedTable* table = find_table(projection, name);
+    if (table) return table;
+
+    if (projection->table_count == projection->table_capacity) {
+        projection->table_capacity = projection->table_capacity ? projection->table_capacity * 2 : 16;
+        projection->tables = realloc(projection->tables,
+                                     projection->table_capacity * sizeof(PlannedTable));
+    }
+    table = &projection->tables[projection->table_count++];
+    memset(table, 0, sizeof(PlannedTable));
+    table->name = name;
+    table->limit = -1;
+    return table;
+}
+
+static void add_column(PlannedTable* table, const char* key) {
+    if (table->column_count == table->column_capacity) {
+        table->column_capacity = table->column_capacity ? table->column_capacity * 2 : 16;
+        table->columns = realloc(table->columns, table->column_capacity * sizeof(char*));
+    }
+    table->columns[table->column_count++] = key;
+}
+
+static int table_full(const PlannedTable* table) {
+    return table->limit >= 0 && table->rows >= table->limit;
+}
+
+static int has_column(const PlannedTable* table, const char* key) {
+    for (size_t i = 0; i < table->column_count; i++) {
+        if (table->columns[i] == key) return 1;
+    }
+    return 0;
+}
+
+static void add_member(Projection* projection, const char* key) {
+    if (projection->member_count == projection->member_capacity) {
+        projection->member_capacity = projection->member_capacity ? projection->member_capacity * 2 : 16;
+        projection->members = realloc(projection->members,
+                                      projection->member_capacity * sizeof(PlannedMember));
+    }
+    PlannedMember* member = &projection->members[projection->member_count++];
+    member->key = key;
+    member->type = 0;
+    member->is_table = 0;
+}
+
+/* Follow the root object through one structural. Below the root's members
+ * only the first structural of each array is looked at. Returns -1 if the
+ * root is not an object, or not one the parser would accept. */
+static int plan_structural(Projection* projection, PlanWalk* walk, Lexer* lexer, size_t offset) {
+    char c = lexer->data[offset];
+
+    if (walk->depth == 0) {
+        if (walk->closed || c != '{') return -1;
+        walk->depth = 1;
+        walk->expect_key = 1;
+        return 0;
+    }
+
+    if (walk->depth > 1) {
+        if (walk->check_first) {
+            projection->members[projection->member_count - 1].is_table = c == '{';
+            walk->check_first = 0;
+        }
+        if (c == '{' || c == '[') walk->depth++;
+        else if (c == '}' || c == ']') walk->depth--;
+        return 0;
+    }
+
+    if (walk->expect_key && c == '"') {
+        YYSTYPE value;
+        if (lexer_scan_token(lexer, offset, &value) != STRING) return -1;
+
+        JsonString name = value.string_val;
+        add_member(projection, intern_key(projection->symbols, name.chars, name.length));
+        if (name.owned) free((char*)name.chars);
+        walk->expect_key = 0;
+    } else if (walk->expect_value) {
+        PlannedMember* member = &projection->members[projection->member_count - 1];
+        member->type = c;
+        if (c == '{' || c == '[') {
+            member->is_table = c == '{';
+            walk->check_first = c == '[';
+            walk->depth = 2;
+        }
+        walk->expect_value = 0;
+    } else if (c == ':' && !walk->expect_key) {
+        walk->expect_value = 1;
+    } else if (c == ',' && !walk->expect_key) {
+        walk->expect_key = 1;
+    } else if (c == '}') {
+        walk->depth = 0;
+        walk->closed = 1;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/* Add the tables a selection names. A value below the root may be found
+ * any number of times, so its table never learns its columns from a first
+ * row; nor does any table when the root was not planned. */
+static void plan_selection(Projection* projection, int lazy) {
+    const TableSelection* selection = projection->selection;
+
+    for (int i = 0; i < selection->count; i++) {
+        const TablePath* path = &selection->paths[i];
+        if (path->length > 1 || lazy) {
+            add_table(projection, path->keys[path->length - 1])->definitions += 2;
+        }
+    }
+    projection->path = malloc(selection->max_length * sizeof(char*));
+    projection->lazy = lazy;
+}
+
+/* Find the root members and the tables they make, by one stage-1 pass */
+static int plan_root(Projection* projection, const char* data, size_t length) {
+    PlanWalk walk = { 0, 0, 0, 0, 0 };
+    Lexer lexer;
+    int status = 0;
+
+    lexer_init(&lexer, data, length);
+    for (size_t start = 0; start < length && status == 0; start += LEXER_WINDOW) {
+        size_t end = start + LEXER_WINDOW < length ? start + LEXER_WINDOW : length;
+        size_t found = index_structurals(&lexer.state, data + start, end - start, lexer.structurals);
+
+        for (size_t i = 0; i < found && status == 0; i++) {
+            status = plan_structural(projection, &walk, &lexer, start + lexer.structurals[i]);
+        }
+    }
+    lexer_free(&lexer);
+    if (status != 0 || !walk.closed) return -1;
+
+    if (projection->selection) {
+        const TableSelection* selection = projection->selection;
+        for (size_t i = 0; i < projection->member_count; i++) {
+            PlannedMember* member = &projection->members[i];
+            if (member->is_table && select_path(selection, &member->key, 1) == SELECT_TABLE) {
+                add_table(projection, member->key)->definitions++;
+            }
+        }
+        plan_selection(projection, 0);
+        return 0;
+    }
+
+    /* main() wraps a root without arrays into a one-row users table */
+    projection->users = intern_key(projection->symbols, "users", strlen("users"));
+    projection->wrapped = 1;
+    for (size_t i = 0; i < projection->member_count; i++) {
+        if (projection->members[i].type == '[') projection->wrapped = 0;
+    }
+
+    if (projection->wrapped) {
+        /* Its columns are the root keys, already known */
+        PlannedTable* users = add_table(projection, projection->users);
+        users->definitions = 1;
+        for (size_t i = 0; i < projection->member_count; i++) {
+            add_column(users, projection->members[i].key);
+        }
+        users->known = 1;
+        users->rows = 1;  /* The root is its first row */
+    } else {
+        for (size_t i = 0; i < projection->member_count; i++) {
+            if (projection->members[i].is_table) {
+                add_table(projection, projection->members[i].key)->definitions++;
+            }
+        }
+    }
+    return 0;
+}
+
+static void free_plan(Projection* projection) {
+    for (size_t i = 0; i < projection->table_count; i++) {
+        free(projection->tables[i].columns);
+    }
+    free(projection->tables);
+    free(projection->members);
+    free(projection->scopes);
+    free(projection->path);
+}
+
+static void push_scope(Projection* projection, ScopeKind kind, PlannedTable* table, int learning) {
+    if (projection->depth == projection->scope_capacity) {
+        projection->scope_capacity = projection->scope_capacity ? projection->scope_capacity * 2 : 16;
+        projection->scopes = realloc(projection->scopes, projection->scope_capacity * sizeof(Scope));
+    }
+    Scope* scope = &projection->scopes[projection->depth++];
+    scope->kind = kind;
+    scope->table = table;
+    scope->key = NULL;
+    scope->learning = learning;
+    scope->defines = learning;
+    scope->first_seen = 0;
+    scope->root_level = 0;
+    scope->level = 0;
+}
+
+/* Count a row of table, or return 0 if --limit leaves it out */
+static int take_row(PlannedTable* table) {
+    if (table_full(table)) return 0;
+    table->rows++;
+    return 1;
+}
+
+/* Whether every table selected below the root is full */
+static int selected_paths_full(Projection* projection) {
+    const TableSelection* selection = projection->selection;
+
+    for (int i = 0; i < selection->count; i++) {
+        const TablePath* path = &selection->paths[i];
+        if (path->length > 1 && !table_full(find_table(projection, path->keys[path->length - 1]))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Whether the rest of the document can change the output, once the table
+ * of the root-level array being read is full. With a plan, it cannot if
+ * every later member is left out, and in a selected path, if every table
+ * below the root is full: a later array of the same table would start its
+ * file again, and a later object would add a table. Without one, every
+ * selected table must have been found, and be full if it has rows. */
+static int rows_complete(Projection* projection, int in_path) {
+    if (projection->lazy) {
+        const TableSelection* selection = projection->selection;
+        for (int i = 0; i < selection->count; i++) {
+            const TablePath* path = &selection->paths[i];
+            PlannedTable* table = find_table(projection, path->keys[path->length - 1]);
+            if (!table->seen || (table->has_rows && !table_full(table))) return 0;
+        }
+        return 1;
+    }
+    if (projection->wrapped) return 0;
+
+    for (size_t i = projection->next_member; i < projection->member_count; i++) {
+        const PlannedMember* member = &projection->members[i];
+        int selected = projection->selection
+            ? select_path(projection->selection, &member->key, 1) : SELECT_TABLE;
+        if (selected == SELECT_PATH && member->type == '{') return 0;
+        if (selected == SELECT_TABLE && member->is_table) return 0;
+    }
+    return !in_path || selected_paths_full(projection);
+}
+
+enum { OPEN_KEEP, OPEN_DROP, OPEN_PATH };
+
+/* Open the scope of a container. Returns OPEN_KEEP if it goes into the
+ * tree, OPEN_PATH if only a selector is followed through it, or OPEN_DROP
+ * if it is left out: an element of rows that is not an object, or a value
+ * a selector cannot lead through. */
+static int open_scope(Projection* projection, int is_object, PendingValue pending) {
+    Scope* parent = projection->depth > 0 ? &projection->scopes[projection->depth - 1] : NULL;
+
+    if (!parent) {
+        push_scope(projection, is_object && projection->valid ? SCOPE_ROOT : SCOPE_KEEP, NULL, 0);
+        return OPEN_KEEP;
+    }
+
+    if (pending == ENTER_PATH) {
+        if (!is_object) return OPEN_DROP;
+        push_scope(projection, SCOPE_PATH, NULL, 0);
+        projection->scopes[projection->depth - 1].level =
+            parent->kind == SCOPE_PATH ? parent->level + 1 : 1;
+        return OPEN_PATH;
+    }
+    if (pending == HOIST) {
+        PlannedTable* table = find_table(projection, projection->pending_key);
+        table->seen = 1;
+        push_scope(projection, is_object ? SCOPE_SCHEMA : SCOPE_ROWS, table, 0);
+        projection->scopes[projection->depth - 1].root_level = 1;
+        return OPEN_KEEP;
+    }
+
+    switch (parent->kind) {
+        case SCOPE_ROOT: {
+            PlannedTable* table = find_table(projection, projection->member_key);
+            table->seen = 1;
+            if (!projection->wrapped) {
+                push_scope(projection, is_object ? SCOPE_SCHEMA : SCOPE_ROWS, table,
+                           table->definitions == 1);
+                projection->scopes[projection->depth - 1].root_level = 1;
+            } else {
+                if (is_object) take_row(table);  /* Not full; see project_key() */
+                push_scope(projection, is_object ? SCOPE_ROW : SCOPE_ROWS, table, 0);
+            }
+            return OPEN_KEEP;
+        }
+
+        case SCOPE_ROWS: {
+            int first = !parent->first_seen;
+            parent->first_seen = 1;
+            /* generate_csv() only writes a root array whose first element is
+             * an object, and process_array() only the objects in it */
+            if (first && !is_object && parent->root_level) parent->table = NULL;
+            if (!is_object || !parent->table) return OPEN_DROP;
+
+            /* generate_csv() starts the file of a root array afresh; its
+             * first row is kept for the schema whatever the limit */
+            if (first && parent->root_level) {
+                parent->table->rows = 0;
+                parent->table->has_rows = 1;
+            }
+            if (!take_row(parent->table) && !(first && parent->root_level)) return OPEN_DROP;
+            push_scope(projection, SCOPE_ROW, parent->table, first && parent->defines);
+            return OPEN_KEEP;
+        }
+
+        case SCOPE_ROW: {
+            /* Only kept under a column that names a table */
+            PlannedTable* table = find_table(projection, parent->key);
+            if (is_object) take_row(table);  /* Not full; see project_key() */
+            push_scope(projection, is_object ? SCOPE_ROW : SCOPE_ROWS, table, 0);
+            return OPEN_KEEP;
+        }
+
+        default:
+            push_scope(projection, SCOPE_KEEP, NULL, 0);
+            return OPEN_KEEP;
+    }
+}
+
+static int start_container(Projection* projection, size_t offset, int is_object) {
+    if (projection->drop_depth > 0) {
+        projection->drop_depth++;
+        return JSON_CONTINUE;
+    }
+    PendingValue pending = projection->pending;
+    projection->pending = PASS_VALUE;
+
+    switch (open_scope(projection, is_object, pending)) {
+        case OPEN_DROP:
+            projection->drop_depth = 1;
+            return JSON_CONTINUE;
+        case OPEN_PATH:
+            return JSON_CONTINUE;
+        default:
+            break;
+    }
+
+    if (pending == HOIST) ast_builder_handler.key(projection->builder, projection->pending_key);
+    return is_object ? ast_builder_handler.start_object(projection->builder, offset)
+                     : ast_builder_handler.start_array(projection->builder, offset);
+}
+
+static int end_container(Projection* projection, int is_object) {
+    if (projection->drop_depth > 0) {
+        projection->drop_depth--;
+        return JSON_CONTINUE;
+    }
+
+    Scope* scope = &projection->scopes[--projection->depth];
+    if (scope->kind == SCOPE_PATH) return JSON_CONTINUE;
+    if (scope->learning && (scope->kind == SCOPE_ROW || scope->kind == SCOPE_SCHEMA)) {
+        scope->table->known = 1;
+    }
+    int status = is_object ? ast_builder_handler.end_object(projection->builder)
+                           : ast_builder_handler.end_array(projection->builder);
+
+    /* Once a row fills its table, the rows after it are not read */
+    Scope* parent = projection->depth > 0 ? &projection->scopes[projection->depth - 1] : NULL;
+    if (status == JSON_CONTINUE && scope->kind == SCOPE_ROW && parent &&
+        parent->kind == SCOPE_ROWS && table_full(scope->table)) {
+        if (parent->root_level &&
+            rows_complete(projection, projection->scopes[projection->depth - 2].kind == SCOPE_PATH)) {
+            return JSON_STOP;
+        }
+        return JSON_SKIP_REST;
+    }
+    return status;
+}
+
+static int project_start_object(void* user, size_t offset) {
+    return start_container(user, offset, 1);
+}
+
+static int project_end_object(void* user) {
+    return end_container(user, 1);
+}
+
+static int project_start_array(void* user, size_t offset) {
+    return start_container(user, offset, 0);
+}
+
+static int project_end_array(void* user) {
+    return end_container(user, 0);
+}
+
+static int project_key(void* user, const char* key) {
+    Projection* projection = user;
+    void* builder = projection->builder;
+
+    if (projection->drop_depth > 0) return JSON_SKIP;
+
+    Scope* scope = &projection->scopes[projection->depth - 1];
+    switch (scope->kind) {
+        case SCOPE_ROOT: {
+            projection->member_key = key;
+            PlannedMember* member = NULL;
+            if (!projection->lazy) {
+                member = projection->next_member < projection->member_count
+                    ? &projection->members[projection->next_member++] : NULL;
+            }
+            if (!projection->lazy && (!member || member->key != key)) {
+                /* Not the document that was planned; keep the rest */
+                projection->valid = 0;
+                scope->kind = SCOPE_KEEP;
+                return ast_builder_handler.key(builder, key);
+            }
+
+            if (projection->selection) {
+                projection->path[0] = key;
+                int selected = select_path(projection->selection, projection->path, 1);
+                /* Unplanned, the value is judged when it opens */
+                if (selected == SELECT_TABLE && (!member || member->is_table)) {
+                    return ast_builder_handler.key(builder, key);
+                }
+                projection->pending = DROP_VALUE;
+                if (selected == SELECT_PATH && (!member || member->type == '{')) {
+                    projection->pending = ENTER_PATH;
+                    return JSON_CONTINUE;
+                }
+                return JSON_SKIP;
+            }
+            if (projection->wrapped) {
+                ast_builder_handler.key(builder, key);
+                return key == projection->users && !table_full(find_table(projection, key))
+                    ? JSON_CONTINUE : JSON_SKIP_CONTAINER;
+            }
+            if (member->is_table) {
+                return ast_builder_handler.key(builder, key);
+            }
+            if (member->type == '[') {
+                /* main() still has to see that the root has an array */
+                ast_builder_handler.key(builder, key);
+                projection->pending = EMPTY_ARRAY;
+                return JSON_SKIP;
+            }
+            projection->pending = DROP_VALUE;
+            return JSON_SKIP;
+        }
+
+        case SCOPE_PATH: {
+            /* Keys on the way are not in the tree; a selected value is
+             * moved up into the root */
+            projection->path[scope->level] = key;
+            int selected = select_path(projection->selection, projection->path, scope->level + 1);
+            if (selected == SELECT_NONE) {
+                projection->pending = DROP_VALUE;
+                return JSON_SKIP;
+            }
+            projection->pending = selected == SELECT_TABLE ? HOIST : ENTER_PATH;
+            projection->pending_key = key;
+            return JSON_CONTINUE;
+        }
+
+        case SCOPE_SCHEMA:
+            if (scope->learning) add_column(scope->table, key);
+            ast_builder_handler.key(builder, key);
+            return JSON_SKIP;
+
+        case SCOPE_ROW: {
+            PlannedTable* table = scope->table;
+            if (scope->learning) {
+                add_column(table, key);
+            } else if (table->known && !has_column(table, key)) {
+                projection->pending = DROP_VALUE;
+                return JSON_SKIP;
+            }
+            scope->key = key;
+            ast_builder_handler.key(builder, key);
+
+            /* A nested row of a full table is written as an empty cell */
+            PlannedTable* nested = find_table(projection, key);
+            return nested && !table_full(nested) ? JSON_CONTINUE : JSON_SKIP_CONTAINER;
+        }
+
+        default:
+            return ast_builder_handler.key(builder, key);
+    }
+}
+
+static int project_scalar(void* user, Node* value) {
+    Projection* projection = user;
+    void* builder = projection->builder;
+
+    if (projection->drop_depth > 0) return JSON_CONTINUE;
+
+    PendingValue pending = projection->pending;
+    projection->pending = PASS_VALUE;
+    if (pending == DROP_VALUE || pending == ENTER_PATH || pending == HOIST) return JSON_CONTINUE;
+    if (pending == EMPTY_ARRAY) {
+        ast_builder_handler.start_array(builder, value->offset);
+        return ast_builder_handler.end_array(builder);
+    }
+
+    Scope* scope = projection->depth > 0 ? &projection->scopes[projection->depth - 1] : NULL;
+    if (scope && scope->kind == SCOPE_ROWS) {
+        if (!scope->first_seen && scope->root_level) scope->table = NULL;
+        scope->first_seen = 1;
+        return JSON_CONTINUE;  /* process_array() only writes objects */
+    }
+    return ast_builder_handler.scalar(builder, value);
+}
+
+static const JsonHandler projection_handler = {
+    project_start_object,
+    project_end_object,
+    project_start_array,
+    project_end_array,
+    project_key,
+    project_scalar
+};
+
+Node* parse_json_projected(const char* data, size_t length, SymbolTable* symbols,
+                           const TableSelection* selection, const RowLimits* limits,
+                           char* error, size_t error_size) {
+    Projection projection;
+    memset(&projection, 0, sizeof(projection));
+    projection.symbols = symbols;
+    projection.selection = selection;
+    projection.valid = 1;
+
+    if (selection && limits) {
+        /* A preview should not have to read the whole document first */
+        plan_selection(&projection, 1);
+    } else if (plan_root(&projection, data, length) != 0) {
+        /* Not an object root, or not valid: nothing to skip */
+        free_plan(&projection);
+        return parse_json(data, length, symbols, error, error_size);
+    }
+    for (size_t i = 0; i < projection.table_count; i++) {
+        projection.tables[i].limit = row_limit(limits, projection.tables[i].name);
+    }
+
+    projection.builder = create_ast_builder();
+    int status = parse_json_events(data, length, symbols, &projection_handler, &projection,
+                                   error, error_size);
+    Node* root = finish_ast_builder(projection.builder, status != 0);
+    free_plan(&projection);
+    return root;
+}
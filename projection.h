@@ -0,0 +1,58 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include <stddef.h>
+#include "ast.h"
+#include "csv_generator.h"
+#include "symbol_table.h"
+
+/* Tables chosen with --tables. Each selector is a root key (users) or a
+ * path of keys from the root in JSONPath form ($.users[*], $.data.items[*]);
+ * the trailing [*] is optional. Keys are interned in the parse's table. */
+typedef struct {
+    const char** keys;
+    int length;
+} TablePath;
+
+typedef struct {
+    TablePath* paths;
+    int count;
+    int max_length;
+} TableSelection;
+
+/* Parse a comma-separated list of selectors. Returns NULL and copies a
+ * message into error if one is not valid. */
+TableSelection* parse_table_selection(const char* spec, SymbolTable* symbols,
+                                      char* error, size_t error_size);
+void free_table_selection(TableSelection* selection);
+
+/* Parse a padded document into the tree that analyze_ast() and
+ * generate_csv() need, rather than the whole document. A stage-1 pass
+ * over the root first finds which root keys name tables. The parse then
+ * skips, without scanning them, values the generator would not read:
+ *   - root members that are not tables,
+ *   - members of a row whose key is not a column of its table, once the
+ *     table's first row has fixed its columns,
+ *   - objects and arrays under a column that does not name a table, which
+ *     are written as empty cells, and
+ *   - the values of a root object, whose keys are all the schema uses.
+ * A skipped member that the generator still looks at is kept as a null or
+ * an empty array, so the schema and output are those of parse_json().
+ *
+ * With a selection, only the selected values are tables: every other root
+ * member is skipped, and the root is not a record to wrap. A value deeper
+ * than the root is moved up into it under its own key, so the generator
+ * finds it like any other table, and what surrounds it is skipped.
+ *
+ * With limits, rows past a table's limit are left out, and the parse
+ * stops, as a success, once no table the rest of the document could add
+ * rows to has room left; nothing after that point is read.
+ *
+ * Inside skipped values the contents of strings are not checked.
+ * Returns NULL and copies a message into error if the input is not valid
+ * JSON. */
+Node* parse_json_projected(const char* data, size_t length, SymbolTable* symbols,
+                           const TableSelection* selection, const RowLimits* limits,
+                           char* error, size_t error_size);
+
+#endif /* PROJECTION_H */
@@ -0,0 +1,444 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+#endif
+#include "read_ahead.h"
+
+/* One buffer of the ring; block n of the file is read into buffer
+ * n % depth */
+typedef struct {
+    char* data;
+    size_t offset;          /* File offset of the block */
+    size_t length;          /* Bytes read so far */
+    size_t wanted;          /* Bytes the block should hold */
+    int ready;
+    struct iovec iov;       /* Unread rest of the block, for io_uring */
+} ReadBlock;
+
+#ifdef HAVE_IO_URING
+/* An io_uring instance driven through the raw system calls */
+typedef struct {
+    int fd;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+    void* sq_map;
+    size_t sq_map_size;
+    void* cq_map;           /* Same as sq_map with IORING_FEAT_SINGLE_MMAP */
+    size_t cq_map_size;
+    size_t sqes_size;
+    unsigned in_flight;
+} Uring;
+#endif
+
+struct ReadAhead {
+    int fd;
+    int owns_fd;            /* 0 for standard input */
+    size_t block_size;
+    int depth;
+    ReadBlock* blocks;
+    size_t taken;           /* Blocks handed to the consumer */
+    int holding;            /* The consumer still has block taken - 1 */
+    char error[256];
+
+#ifdef HAVE_IO_URING
+    /* io_uring: the consumer submits and reaps the reads itself */
+    int uring_started;
+    Uring uring;
+    size_t file_size;
+    size_t requested;       /* Blocks whose reads have been submitted */
+    int failed;
+#endif
+
+    /* Otherwise one thread reads ahead into the free buffers */
+    size_t filled;          /* Blocks read */
+    int done;               /* 1 at the end of the file, -1 on an error */
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t block_filled;
+    pthread_cond_t block_freed;
+};
+
+#ifdef HAVE_IO_URING
+static int uring_init(Uring* uring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(uring, 0, sizeof(Uring));
+    uring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (uring->fd < 0) return -1;
+
+    uring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    uring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (uring->cq_map_size > uring->sq_map_size) uring->sq_map_size = uring->cq_map_size;
+        uring->cq_map_size = 0;
+    }
+
+    uring->sq_map = mmap(NULL, uring->sq_map_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+    if (uring->sq_map == MAP_FAILED) {
+        close(uring->fd);
+        return -1;
+    }
+    uring->cq_map = uring->sq_map;
+    if (uring->cq_map_size) {
+        uring->cq_map = mmap(NULL, uring->cq_map_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+        if (uring->cq_map == MAP_FAILED) {
+            munmap(uring->sq_map, uring->sq_map_size);
+            close(uring->fd);
+            return -1;
+        }
+    }
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        if (uring->cq_map_size) munmap(uring->cq_map, uring->cq_map_size);
+        munmap(uring->sq_map, uring->sq_map_size);
+        close(uring->fd);
+        return -1;
+    }
+
+    char* sq = uring->sq_map;
+    char* cq = uring->cq_map;
+    uring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    uring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    uring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    uring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    uring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    uring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return 0;
+}
+
+static void uring_free(Uring* uring) {
+    munmap(uring->sqes, uring->sqes_size);
+    if (uring->cq_map_size) munmap(uring->cq_map, uring->cq_map_size);
+    munmap(uring->sq_map, uring->sq_map_size);
+    close(uring->fd);
+}
+
+/* Queue and submit one readv of iov at offset. Never more reads are in
+ * flight than the ring has entries, so a slot is always free. */
+static int uring_readv(Uring* uring, int fd, struct iovec* iov, size_t offset, uint64_t user_data) {
+    unsigned tail = *uring->sq_tail;
+    unsigned index = tail & *uring->sq_mask;
+    struct io_uring_sqe* sqe = &uring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)iov;
+    sqe->len = 1;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    uring->sq_array[index] = index;
+    __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    int submitted;
+    do {
+        submitted = (int)syscall(__NR_io_uring_enter, uring->fd, 1, 0, 0, NULL, 0);
+    } while (submitted < 0 && errno == EINTR);
+    if (submitted < 0) return -1;
+    uring->in_flight++;
+    return 0;
+}
+
+/* Take the next completion, waiting for one if none has arrived */
+static int uring_wait(Uring* uring, struct io_uring_cqe* completion) {
+    for (;;) {
+        unsigned head = *uring->cq_head;
+        if (head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+            *completion = uring->cqes[head & *uring->cq_mask];
+            __atomic_store_n(uring->cq_head, head + 1, __ATOMIC_RELEASE);
+            uring->in_flight--;
+            return 0;
+        }
+        if (syscall(__NR_io_uring_enter, uring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+            errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/* Submit the read of the next block, if the file has one */
+static int request_block(ReadAhead* reader) {
+    size_t offset = reader->requested * reader->block_size;
+    if (offset >= reader->file_size) return 0;
+
+    ReadBlock* block = &reader->blocks[reader->requested % reader->depth];
+    block->offset = offset;
+    block->length = 0;
+    block->wanted = reader->file_size - offset < reader->block_size
+                        ? reader->file_size - offset : reader->block_size;
+    block->ready = 0;
+    block->iov.iov_base = block->data;
+    block->iov.iov_len = block->wanted;
+    reader->requested++;
+    return uring_readv(&reader->uring, reader->fd, &block->iov, block->offset,
+                       (uint64_t)(block - reader->blocks));
+}
+
+/* read_ahead_next() for io_uring */
+static long next_uring_block(ReadAhead* reader, const char** data) {
+    if (reader->failed) return -1;
+    if (reader->holding) {
+        reader->holding = 0;
+        if (request_block(reader) != 0) {
+            snprintf(reader->error, sizeof(reader->error), "io_uring submission failed: %s",
+                     strerror(errno));
+            reader->failed = 1;
+            return -1;
+        }
+    }
+    if (reader->taken * reader->block_size >= reader->file_size) return 0;
+
+    ReadBlock* wanted = &reader->blocks[reader->taken % reader->depth];
+    while (!wanted->ready) {
+        struct io_uring_cqe completion;
+        if (uring_wait(&reader->uring, &completion) != 0) {
+            snprintf(reader->error, sizeof(reader->error), "io_uring wait failed: %s",
+                     strerror(errno));
+            reader->failed = 1;
+            return -1;
+        }
+
+        ReadBlock* block = &reader->blocks[completion.user_data];
+        int result = completion.res;
+        if (result == -EINTR || result == -EAGAIN) {
+            result = 0;
+        } else if (result < 0) {
+            snprintf(reader->error, sizeof(reader->error), "Read failed: %s", strerror(-result));
+            reader->failed = 1;
+            return -1;
+        } else if (result == 0) {
+            /* The file shrank; it ends with this block */
+            reader->file_size = block->offset + block->length;
+            block->ready = 1;
+            continue;
+        }
+
+        /* A short read is continued from where it stopped */
+        block->length += (size_t)result;
+        if (block->length < block->wanted) {
+            block->iov.iov_base = block->data + block->length;
+            block->iov.iov_len = block->wanted - block->length;
+            if (uring_readv(&reader->uring, reader->fd, &block->iov, block->offset + block->length,
+                            completion.user_data) != 0) {
+                snprintf(reader->error, sizeof(reader->error), "io_uring submission failed: %s",
+                         strerror(errno));
+                reader->failed = 1;
+                return -1;
+            }
+        } else {
+            block->ready = 1;
+        }
+    }
+
+    reader->taken++;
+    if (wanted->length == 0) return 0;
+    reader->holding = 1;
+    *data = wanted->data;
+    return (long)wanted->length;
+}
+
+/* Set up io_uring for a regular file and queue the first reads */
+static int start_uring(ReadAhead* reader) {
+    struct stat st;
+    if (fstat(reader->fd, &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    if (uring_init(&reader->uring, (unsigned)reader->depth) != 0) return 0;
+
+    reader->uring_started = 1;
+    reader->file_size = (size_t)st.st_size;
+    for (int i = 0; i < reader->depth; i++) {
+        if (request_block(reader) != 0) {
+            /* Reads already queued complete before the ring is torn down */
+            snprintf(reader->error, sizeof(reader->error), "io_uring submission failed: %s",
+                     strerror(errno));
+            reader->failed = 1;
+            break;
+        }
+    }
+    return 1;
+}
+#endif
+
+/* Fill a block with read(), or pread() when the file can seek, stopping
+ * early only at the end of the file. Returns 0 or -1. */
+static int read_block(int fd, int seekable, ReadBlock* block) {
+    block->length = 0;
+    while (block->length < block->wanted) {
+        ssize_t n = seekable ? pread(fd, block->data + block->length, block->wanted - block->length,
+                                     (off_t)(block->offset + block->length))
+                             : read(fd, block->data + block->length, block->wanted - block->length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        block->length += (size_t)n;
+    }
+    return 0;
+}
+
+static void* read_blocks(void* arg) {
+    ReadAhead* reader = arg;
+    struct stat st;
+    int seekable = fstat(reader->fd, &st) == 0 && S_ISREG(st.st_mode);
+    size_t offset = 0;
+
+    pthread_mutex_lock(&reader->lock);
+    while (!reader->done) {
+        while (!reader->stop &&
+               reader->filled - (reader->taken - reader->holding) == (size_t)reader->depth) {
+            pthread_cond_wait(&reader->block_freed, &reader->lock);
+        }
+        if (reader->stop) break;
+
+        ReadBlock* block = &reader->blocks[reader->filled % reader->depth];
+        pthread_mutex_unlock(&reader->lock);
+
+        block->offset = offset;
+        block->wanted = reader->block_size;
+        int status = read_block(reader->fd, seekable, block);
+        offset += block->length;
+
+        pthread_mutex_lock(&reader->lock);
+        if (status != 0) {
+            snprintf(reader->error, sizeof(reader->error), "Read failed: %s", strerror(errno));
+            reader->done = -1;
+        } else {
+            if (block->length > 0) reader->filled++;
+            if (block->length < block->wanted) reader->done = 1;
+        }
+        pthread_cond_broadcast(&reader->block_filled);
+    }
+    pthread_mutex_unlock(&reader->lock);
+    return NULL;
+}
+
+ReadAhead* open_read_ahead(const char* path, size_t block_size, int depth) {
+    int from_stdin = strcmp(path, "-") == 0;
+    int fd = from_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd == -1) return NULL;
+
+    ReadAhead* reader = calloc(1, sizeof(ReadAhead));
+    reader->fd = fd;
+    reader->owns_fd = !from_stdin;
+    reader->block_size = block_size;
+    reader->depth = depth > 0 ? depth : 1;
+    reader->blocks = calloc(reader->depth, sizeof(ReadBlock));
+    for (int i = 0; i < reader->depth; i++) {
+        reader->blocks[i].data = malloc(block_size);
+    }
+
+#ifdef HAVE_IO_URING
+    if (start_uring(reader)) return reader;
+#endif
+
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->block_filled, NULL);
+    pthread_cond_init(&reader->block_freed, NULL);
+    if (pthread_create(&reader->thread, NULL, read_blocks, reader) != 0) {
+        pthread_mutex_destroy(&reader->lock);
+        pthread_cond_destroy(&reader->block_filled);
+        pthread_cond_destroy(&reader->block_freed);
+        for (int i = 0; i < reader->depth; i++) free(reader->blocks[i].data);
+        free(reader->blocks);
+        if (reader->owns_fd) close(fd);
+        free(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+long read_ahead_next(ReadAhead* reader, const char** data) {
+#ifdef HAVE_IO_URING
+    if (reader->uring_started) return next_uring_block(reader, data);
+#endif
+    pthread_mutex_lock(&reader->lock);
+    if (reader->holding) {
+        reader->holding = 0;
+        pthread_cond_broadcast(&reader->block_freed);
+    }
+    while (reader->taken == reader->filled && !reader->done) {
+        pthread_cond_wait(&reader->block_filled, &reader->lock);
+    }
+
+    long length;
+    if (reader->taken < reader->filled) {
+        ReadBlock* block = &reader->blocks[reader->taken++ % reader->depth];
+        reader->holding = 1;
+        *data = block->data;
+        length = (long)block->length;
+    } else {
+        length = reader->done < 0 ? -1 : 0;
+    }
+    pthread_mutex_unlock(&reader->lock);
+    return length;
+}
+
+const char* read_ahead_error(const ReadAhead* reader) {
+    return reader->error;
+}
+
+const char* read_ahead_backend(const ReadAhead* reader) {
+#ifdef HAVE_IO_URING
+    if (reader->uring_started) return "io_uring";
+#endif
+    (void)reader;
+    return "thread";
+}
+
+void close_read_ahead(ReadAhead* reader) {
+    if (!reader) return;
+
+#ifdef HAVE_IO_URING
+    if (reader->uring_started) {
+        /* The kernel may still write into the buffers until each read
+         * still in flight has completed */
+        struct io_uring_cqe completion;
+        while (reader->uring.in_flight > 0 && uring_wait(&reader->uring, &completion) == 0) {
+        }
+        uring_free(&reader->uring);
+    } else
+#endif
+    {
+        pthread_mutex_lock(&reader->lock);
+        reader->stop = 1;
+        pthread_cond_broadcast(&reader->block_freed);
+        pthread_mutex_unlock(&reader->lock);
+        pthread_join(reader->thread, NULL);
+        pthread_mutex_destroy(&reader->lock);
+        pthread_cond_destroy(&reader->block_filled);
+        pthread_cond_destroy(&reader->block_freed);
+    }
+
+    for (int i = 0; i < reader->depth; i++) free(reader->blocks[i].data);
+    free(reader->blocks);
+    if (reader->owns_fd) close(reader->fd);
+    free(reader);
+}
@@ -0,0 +1,31 @@
+#ifndef READ_AHEAD_H
+#define READ_AHEAD_H
+
+#include <stddef.h>
+
+/* Sequential reader that keeps several reads in flight ahead of its
+ * consumer, so a parser fed from it works while the disk reads the next
+ * blocks instead of stalling on each one. On Linux a regular file is read
+ * through io_uring, with up to depth reads of block_size bytes queued at
+ * once; where io_uring is not available, and for pipes, one thread reads
+ * ahead into the same number of buffers. */
+typedef struct ReadAhead ReadAhead;
+
+/* Open path ("-" for standard input) and start reading. Returns NULL if
+ * it cannot be opened or the reads cannot be started. */
+ReadAhead* open_read_ahead(const char* path, size_t block_size, int depth);
+
+/* Wait for the next block of the file. The block stays valid until the
+ * next call. Returns its length, 0 at the end of the file, or -1 with a
+ * message in read_ahead_error() if a read failed. */
+long read_ahead_next(ReadAhead* reader, const char** block);
+
+const char* read_ahead_error(const ReadAhead* reader);
+
+/* "io_uring" or "thread", for messages */
+const char* read_ahead_backend(const ReadAhead* reader);
+
+/* Cancel the reads still in flight and close the file */
+void close_read_ahead(ReadAhead* reader);
+
+#endif /* READ_AHEAD_H */
@@ -0,0 +1,347 @@
+#include <stdint.h>
+#include <string.h>
+#include "string_decoder.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+/* Find the closing quote of a string body */
+const char* scan_string_body(const char* p, const char* limit, int* flags) {
+    int found = 0;
+
+    while (p < limit) {
+#ifdef __SSE2__
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        unsigned special = (unsigned)_mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+        unsigned high = (unsigned)_mm_movemask_epi8(v);
+
+        if (!special) {
+            if (high) found |= STRING_HAS_NON_ASCII;
+            p += 16;
+            continue;
+        }
+
+        /* Only the bytes before the quote or backslash belong to the body */
+        unsigned pos = (unsigned)__builtin_ctz(special);
+        if (high & ((1u << pos) - 1)) found |= STRING_HAS_NON_ASCII;
+        p += pos;
+#else
+        unsigned char c = (unsigned char)*p;
+        if (c != '"' && c != '\\') {
+            if (c >= 0x80) found |= STRING_HAS_NON_ASCII;
+            p++;
+            continue;
+        }
+#endif
+        if (p >= limit) break;
+        if (*p == '"') {
+            *flags = found;
+            return p;
+        }
+
+        /* Backslash: the next byte is escaped, whatever it is */
+        found |= STRING_HAS_ESCAPES;
+        p += 2;
+    }
+
+    return NULL;
+}
+
+/* Length of the UTF-8 sequence at s, or 0 if it is malformed */
+static size_t utf8_sequence_length(const unsigned char* s, size_t avail) {
+    unsigned char c = s[0];
+
+    if (c < 0x80) return 1;
+    if (c < 0xC2) return 0;  /* Stray continuation or overlong 2-byte lead */
+    if (c < 0xE0) {
+        return avail >= 2 && (s[1] & 0xC0) == 0x80 ? 2 : 0;
+    }
+    if (c < 0xF0) {
+        if (avail < 3 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80) return 0;
+        if (c == 0xE0 && s[1] < 0xA0) return 0;  /* Overlong */
+        if (c == 0xED && s[1] > 0x9F) return 0;  /* Surrogate */
+        return 3;
+    }
+    if (c < 0xF5) {
+        if (avail < 4 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 ||
+            (s[3] & 0xC0) != 0x80) return 0;
+        if (c == 0xF0 && s[1] < 0x90) return 0;  /* Overlong */
+        if (c == 0xF4 && s[1] > 0x8F) return 0;  /* Above U+10FFFF */
+        return 4;
+    }
+    return 0;
+}
+
+static int validate_utf8_scalar(const unsigned char* s, size_t len) {
+    size_t i = 0;
+
+    while (i < len) {
+        /* Skip ASCII a word at a time */
+        while (i + 8 <= len) {
+            uint64_t word;
+            memcpy(&word, s + i, sizeof(word));
+            if (word & 0x8080808080808080ULL) break;
+            i += 8;
+        }
+        if (i >= len) break;
+
+        size_t n = utf8_sequence_length(s + i, len - i);
+        if (n == 0) return 0;
+        i += n;
+    }
+
+    return 1;
+}
+
+#ifdef HAVE_X86_SIMD
+/* Lookup-table validation (Keiser and Lemire, "Validating UTF-8 in less
+ * than one instruction per byte"). Each byte is classified by the high
+ * nibble of itself and the low and high nibbles of the byte before it; an
+ * error bit survives the AND of the three lookups only for an invalid
+ * pair. Sequences of three and four bytes are then checked against the
+ * lead bytes two and three positions back. */
+#define TOO_SHORT      (1 << 0)  /* 11______ 0_______ or 11______ 11______ */
+#define TOO_LONG       (1 << 1)  /* 0_______ 10______ */
+#define OVERLONG_3     (1 << 2)  /* 11100000 100_____ */
+#define TOO_LARGE      (1 << 3)  /* 11110100 1001____ and above */
+#define SURROGATE      (1 << 4)  /* 11101101 101_____ */
+#define OVERLONG_2     (1 << 5)  /* 1100000_ 10______ */
+#define TOO_LARGE_1000 (1 << 6)  /* 11110101 1000____ and above */
+#define OVERLONG_4     (1 << 6)  /* 11110000 1000____ */
+#define TWO_CONTS      (1 << 7)  /* 10______ 10______ */
+#define CARRY          (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+typedef struct {
+    __m128i error;
+    __m128i prev_input;
+    __m128i prev_incomplete;
+} Utf8Checker;
+
+__attribute__((target("ssse3")))
+static __m128i high_nibbles(__m128i v) {
+    return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+__attribute__((target("ssse3")))
+static void check_utf8_block(Utf8Checker* checker, __m128i input) {
+    if (_mm_movemask_epi8(input) == 0) {
+        /* ASCII right after an unfinished sequence is an error */
+        checker->error = _mm_or_si128(checker->error, checker->prev_incomplete);
+        checker->prev_incomplete = _mm_setzero_si128();
+        checker->prev_input = input;
+        return;
+    }
+
+    const __m128i byte_1_high_table = _mm_setr_epi8(
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        (char)TWO_CONTS, (char)TWO_CONTS, (char)TWO_CONTS, (char)TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+    const __m128i byte_1_low_table = _mm_setr_epi8(
+        (char)(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4),
+        (char)(CARRY | OVERLONG_2),
+        (char)CARRY,
+        (char)CARRY,
+        (char)(CARRY | TOO_LARGE),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000));
+    const __m128i byte_2_high_table = _mm_setr_epi8(
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+    __m128i prev1 = _mm_alignr_epi8(input, checker->prev_input, 15);
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(_mm_shuffle_epi8(byte_1_high_table, high_nibbles(prev1)),
+                      _mm_shuffle_epi8(byte_1_low_table,
+                                       _mm_and_si128(prev1, _mm_set1_epi8(0x0F)))),
+        _mm_shuffle_epi8(byte_2_high_table, high_nibbles(input)));
+
+    /* Bytes two after a 3- or 4-byte lead, or three after a 4-byte lead,
+     * must be continuations; TWO_CONTS marked exactly those above. */
+    __m128i prev2 = _mm_alignr_epi8(input, checker->prev_input, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, checker->prev_input, 13);
+    __m128i is_third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+    __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third, is_fourth),
+                                                 _mm_set1_epi8((char)0x80));
+    checker->error = _mm_or_si128(checker->error,
+                                  _mm_xor_si128(must_be_continuation, special));
+
+    /* A lead byte in the last three positions may still be waiting for
+     * continuation bytes */
+    const __m128i max_tail = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    checker->prev_incomplete = _mm_subs_epu8(input, max_tail);
+    checker->prev_input = input;
+}
+
+__attribute__((target("ssse3")))
+static int validate_utf8_ssse3(const unsigned char* s, size_t len) {
+    Utf8Checker checker;
+    checker.error = _mm_setzero_si128();
+    checker.prev_input = _mm_setzero_si128();
+    checker.prev_incomplete = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        check_utf8_block(&checker, _mm_loadu_si128((const __m128i*)(s + i)));
+    }
+    if (i < len) {
+        /* Zero padding is ASCII, so a sequence cut off at the end still fails */
+        unsigned char tail[16] = {0};
+        memcpy(tail, s + i, len - i);
+        check_utf8_block(&checker, _mm_loadu_si128((const __m128i*)tail));
+    }
+
+    __m128i error = _mm_or_si128(checker.error, checker.prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+/* Check that s[0, len) is well-formed UTF-8 */
+int validate_utf8(const char* s, size_t len) {
+#ifdef HAVE_X86_SIMD
+    if (__builtin_cpu_supports("ssse3")) {
+        return validate_utf8_ssse3((const unsigned char*)s, len);
+    }
+#endif
+    return validate_utf8_scalar((const unsigned char*)s, len);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* Read the four hex digits of a \u escape */
+static long read_hex4(const char* p) {
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_value(p[i]);
+        if (digit < 0) return -1;
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+static size_t encode_utf8(unsigned long cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* Decode the escape sequences of a string body into dst */
+long decode_json_string(const char* src, size_t len, char* dst) {
+    const char* p = src;
+    const char* end = src + len;
+    char* out = dst;
+    int non_ascii = 0;
+
+    while (p < end) {
+#ifdef __SSE2__
+        /* Copy 16 bytes at a time up to the next backslash; dst has slack
+         * for the overshoot */
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        _mm_storeu_si128((__m128i*)out, v);
+        unsigned backslash = (unsigned)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        size_t run = backslash ? (size_t)__builtin_ctz(backslash) : 16;
+        if (run > (size_t)(end - p)) run = end - p;
+        if ((unsigned)_mm_movemask_epi8(v) & ((1u << run) - 1)) non_ascii = 1;
+        p += run;
+        out += run;
+        if (p >= end || *p != '\\') continue;
+#else
+        if (*p != '\\') {
+            if ((unsigned char)*p >= 0x80) non_ascii = 1;
+            *out++ = *p++;
+            continue;
+        }
+#endif
+        if (p + 1 >= end) return -1;
+        p++;
+        switch (*p++) {
+            case 'n': *out++ = '\n'; break;
+            case 't': *out++ = '\t'; break;
+            case 'r': *out++ = '\r'; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case '/': *out++ = '/'; break;
+            case '\\': *out++ = '\\'; break;
+            case '"': *out++ = '"'; break;
+            case 'u': {
+                if (end - p < 4) return -1;
+                long cp = read_hex4(p);
+                if (cp < 0) return -1;
+                p += 4;
+
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    /* High surrogate: a low surrogate escape must follow */
+                    if (end - p < 6 || p[0] != '\\' || p[1] != 'u') return -1;
+                    long low = read_hex4(p + 2);
+                    if (low < 0xDC00 || low > 0xDFFF) return -1;
+                    p += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return -1;  /* Lone low surrogate */
+                }
+
+                out += encode_utf8((unsigned long)cp, out);
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+
+    *out = '\0';
+
+    /* Escapes always decode to whole sequences, so the output is valid
+     * exactly when the raw bytes copied around them were */
+    if (non_ascii && !validate_utf8(dst, out - dst)) {
+        return -1;
+    }
+
+    return out - dst;
+}
@@ -0,0 +1,26 @@
+#ifndef STRING_DECODER_H
+#define STRING_DECODER_H
+
+#include <stddef.h>
+
+/* Flags reported by scan_string_body() */
+#define STRING_HAS_ESCAPES   1
+#define STRING_HAS_NON_ASCII 2
+
+/* Find the closing quote of a string whose body starts at p, reporting in
+ * flags whether the body contains escapes or non-ASCII bytes. Returns NULL
+ * if no closing quote occurs before limit. Reads in 16-byte steps, so at
+ * least 16 readable bytes must follow limit. */
+const char* scan_string_body(const char* p, const char* limit, int* flags);
+
+/* Check that s[0, len) is well-formed UTF-8: no overlong forms, surrogates,
+ * truncated sequences or code points above U+10FFFF */
+int validate_utf8(const char* s, size_t len);
+
+/* Decode the escape sequences of a string body into dst, which needs room
+ * for len + 16 bytes, and NUL-terminate it. \uXXXX escapes, including
+ * surrogate pairs, become UTF-8. The result is checked to be valid UTF-8.
+ * Returns the decoded length, or -1 on an invalid escape or invalid UTF-8. */
+long decode_json_string(const char* src, size_t len, char* dst);
+
+#endif /* STRING_DECODER_H */
@@ -0,0 +1,229 @@
+#include <string.h>
+#include "structural_index.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+/* Per-block bitmaps, one bit per input byte */
+typedef struct {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;          /* { } [ ] : , */
+    uint64_t whitespace;  /* space, tab, newline, carriage return */
+} BlockMasks;
+
+typedef void (*ClassifyFn)(const uint8_t* block, BlockMasks* masks);
+
+/* Character classes for the scalar fallback */
+enum {
+    CLASS_QUOTE = 1,
+    CLASS_BACKSLASH = 2,
+    CLASS_OP = 4,
+    CLASS_WHITESPACE = 8
+};
+
+static const uint8_t char_class[256] = {
+    ['"'] = CLASS_QUOTE,
+    ['\\'] = CLASS_BACKSLASH,
+    ['{'] = CLASS_OP, ['}'] = CLASS_OP,
+    ['['] = CLASS_OP, [']'] = CLASS_OP,
+    [':'] = CLASS_OP, [','] = CLASS_OP,
+    [' '] = CLASS_WHITESPACE, ['\t'] = CLASS_WHITESPACE,
+    ['\n'] = CLASS_WHITESPACE, ['\r'] = CLASS_WHITESPACE
+};
+
+static void classify_scalar(const uint8_t* block, BlockMasks* masks) {
+    memset(masks, 0, sizeof(BlockMasks));
+
+    for (int i = 0; i < 64; i++) {
+        uint8_t cls = char_class[block[i]];
+        uint64_t bit = 1ULL << i;
+        if (cls & CLASS_QUOTE) masks->quote |= bit;
+        if (cls & CLASS_BACKSLASH) masks->backslash |= bit;
+        if (cls & CLASS_OP) masks->op |= bit;
+        if (cls & CLASS_WHITESPACE) masks->whitespace |= bit;
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+/* '[' and ']' differ from '{' and '}' only in bit 0x20, so OR-ing that bit
+ * in lets one compare catch both bracket kinds. */
+
+__attribute__((target("sse2")))
+static void classify_sse2(const uint8_t* block, BlockMasks* masks) {
+    memset(masks, 0, sizeof(BlockMasks));
+
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                         _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        int shift = 16 * i;
+        masks->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << shift;
+        masks->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+        masks->op |= (uint64_t)(uint16_t)_mm_movemask_epi8(op) << shift;
+        masks->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(ws) << shift;
+    }
+}
+
+__attribute__((target("avx2")))
+static void classify_avx2(const uint8_t* block, BlockMasks* masks) {
+    memset(masks, 0, sizeof(BlockMasks));
+
+    for (int i = 0; i < 2; i++) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(block + 32 * i));
+        __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                            _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        int shift = 32 * i;
+        masks->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << shift;
+        masks->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << shift;
+        masks->op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << shift;
+        masks->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << shift;
+    }
+}
+#endif
+
+/* Pick the widest classifier the CPU supports */
+static ClassifyFn select_classifier(void) {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return classify_avx2;
+    if (__builtin_cpu_supports("sse2")) return classify_sse2;
+#endif
+    return classify_scalar;
+}
+
+/* Bits of bytes preceded by an odd-length run of backslashes */
+static uint64_t find_escaped(uint64_t backslash, uint64_t* prev_escaped) {
+    const uint64_t even_bits = 0x5555555555555555ULL;
+
+    backslash &= ~*prev_escaped;
+    uint64_t follows_escape = (backslash << 1) | *prev_escaped;
+
+    /* Runs starting on odd bits: adding them to the backslash mask carries
+     * through each run and leaves a bit just past its end. */
+    uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t sequences_on_even;
+    *prev_escaped = __builtin_add_overflow(odd_starts, backslash, &sequences_on_even);
+    uint64_t invert_mask = sequences_on_even << 1;
+
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+/* Bit i becomes the XOR of bits 0..i: set from an opening quote up to,
+ * but not including, its closing quote. */
+static uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+void init_index_state(IndexState* state) {
+    state->prev_in_string = 0;
+    state->prev_escaped = 0;
+    state->prev_scalar = 0;
+}
+
+size_t index_structurals(IndexState* state, const char* data, size_t length, uint32_t* out) {
+    ClassifyFn classify = select_classifier();
+    size_t count = 0;
+
+    for (size_t block = 0; block < length; block += 64) {
+        BlockMasks masks;
+        classify((const uint8_t*)data + block, &masks);
+
+        /* Bytes past the end count as whitespace so they start nothing */
+        if (length - block < 64) {
+            uint64_t valid = (1ULL << (length - block)) - 1;
+            masks.quote &= valid;
+            masks.backslash &= valid;
+            masks.op &= valid;
+            masks.whitespace |= ~valid;
+        }
+
+        uint64_t escaped = find_escaped(masks.backslash, &state->prev_escaped);
+        uint64_t quote = masks.quote & ~escaped;
+        uint64_t in_string = prefix_xor(quote) ^ state->prev_in_string;
+        state->prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+
+        uint64_t scalar = ~(masks.op | masks.whitespace | quote | in_string);
+        uint64_t scalar_start = scalar & ~((scalar << 1) | state->prev_scalar);
+        state->prev_scalar = scalar >> 63;
+
+        uint64_t structurals = (masks.op & ~in_string) | (quote & in_string) | scalar_start;
+
+        while (structurals) {
+            out[count++] = (uint32_t)(block + __builtin_ctzll(structurals));
+            structurals &= structurals - 1;
+        }
+    }
+
+    return count;
+}
+
+static size_t count_newlines_scalar(const uint8_t* data, size_t length) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("sse2")))
+static size_t count_newlines_sse2(const uint8_t* data, size_t length) {
+    size_t count = 0, i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+    }
+    return count + count_newlines_scalar(data + i, length - i);
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t count_newlines_avx2(const uint8_t* data, size_t length) {
+    size_t count = 0, i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        count += __builtin_popcount((uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+    }
+    return count + count_newlines_scalar(data + i, length - i);
+}
+#endif
+
+size_t count_newlines(const char* data, size_t length) {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return count_newlines_avx2((const uint8_t*)data, length);
+    if (__builtin_cpu_supports("sse2")) return count_newlines_sse2((const uint8_t*)data, length);
+#endif
+    return count_newlines_scalar((const uint8_t*)data, length);
+}
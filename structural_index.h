@@ -0,0 +1,30 @@
+#ifndef STRUCTURAL_INDEX_H
+#define STRUCTURAL_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Scanner state carried from one 64-byte block to the next */
+typedef struct {
+    uint64_t prev_in_string;  /* All ones if the last block ended inside a string */
+    uint64_t prev_escaped;    /* 1 if the next block starts with an escaped byte */
+    uint64_t prev_scalar;     /* 1 if the last block ended inside a scalar */
+} IndexState;
+
+/* Reset the state for a scan starting outside any string or scalar */
+void init_index_state(IndexState* state);
+
+/* Stage 1 of the lexer. Appends to out the offset (relative to data) of
+ * every { } [ ] : , and opening quote outside strings, plus the first byte
+ * of every bare scalar (number, true, false, null), and returns the count.
+ * Whole 64-byte blocks are read, so data must stay readable up to length
+ * rounded up to a multiple of 64. State carries over between calls, so a
+ * document can be indexed in consecutive windows; every window but the
+ * last must be a multiple of 64 bytes long. */
+size_t index_structurals(IndexState* state, const char* data, size_t length, uint32_t* out);
+
+/* Count the '\n' bytes in data[0, length). Only used to turn a byte offset
+ * into a line number when reporting an error. */
+size_t count_newlines(const char* data, size_t length);
+
+#endif /* STRUCTURAL_INDEX_H */
@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include <string.h>
+#include "symbol_table.h"
+
+#define INITIAL_CAPACITY 64
+#define KEY_BLOCK_SIZE 4096
+
+/* FNV-1a */
+static uint64_t hash_key(const char* key, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+SymbolTable* create_symbol_table(void) {
+    SymbolTable* table = malloc(sizeof(SymbolTable));
+    table->capacity = INITIAL_CAPACITY;
+    table->count = 0;
+    table->slots = calloc(table->capacity, sizeof(Symbol));
+    table->blocks = NULL;
+    table->shared = NULL;
+    pthread_mutex_init(&table->lock, NULL);
+    return table;
+}
+
+SymbolTable* create_local_symbol_table(SymbolTable* shared) {
+    SymbolTable* table = create_symbol_table();
+    table->shared = shared;
+    return table;
+}
+
+void free_symbol_table(SymbolTable* table) {
+    if (!table) return;
+
+    KeyBlock* block = table->blocks;
+    while (block) {
+        KeyBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    pthread_mutex_destroy(&table->lock);
+    free(table->slots);
+    free(table);
+}
+
+/* Copy a key into the arena, starting a new block when the current one is full */
+static const char* store_key(SymbolTable* table, const char* key, size_t length) {
+    KeyBlock* block = table->blocks;
+
+    if (!block || block->size - block->used < length + 1) {
+        size_t size = length + 1 > KEY_BLOCK_SIZE ? length + 1 : KEY_BLOCK_SIZE;
+        block = malloc(sizeof(KeyBlock) + size);
+        block->used = 0;
+        block->size = size;
+        block->next = table->blocks;
+        table->blocks = block;
+    }
+
+    char* copy = block->bytes + block->used;
+    memcpy(copy, key, length);
+    copy[length] = '\0';
+    block->used += length + 1;
+    return copy;
+}
+
+static void grow(SymbolTable* table) {
+    size_t capacity = table->capacity * 2;
+    Symbol* slots = calloc(capacity, sizeof(Symbol));
+
+    for (size_t i = 0; i < table->capacity; i++) {
+        Symbol* symbol = &table->slots[i];
+        if (!symbol->key) continue;
+
+        size_t j = symbol->hash & (capacity - 1);
+        while (slots[j].key) j = (j + 1) & (capacity - 1);
+        slots[j] = *symbol;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+}
+
+const char* intern_key(SymbolTable* table, const char* key, size_t length) {
+    uint64_t hash = hash_key(key, length);
+    size_t i = hash & (table->capacity - 1);
+
+    while (table->slots[i].key) {
+        Symbol* symbol = &table->slots[i];
+        if (symbol->hash == hash && symbol->length == length &&
+            memcmp(symbol->key, key, length) == 0) {
+            return symbol->key;
+        }
+        i = (i + 1) & (table->capacity - 1);
+    }
+
+    Symbol* symbol = &table->slots[i];
+    symbol->hash = hash;
+    symbol->length = length;
+    if (table->shared) {
+        /* A local table stores no bytes of its own */
+        pthread_mutex_lock(&table->shared->lock);
+        symbol->key = intern_key(table->shared, key, length);
+        pthread_mutex_unlock(&table->shared->lock);
+    } else {
+        symbol->key = store_key(table, key, length);
+    }
+    table->count++;
+
+    /* Keep the load factor under 1/2 */
+    if (table->count * 2 > table->capacity) {
+        const char* interned = symbol->key;
+        grow(table);
+        return interned;
+    }
+    return symbol->key;
+}
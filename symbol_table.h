@@ -0,0 +1,49 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t hash;
+    size_t length;
+    const char* key;    /* NUL-terminated copy in the table's arena */
+} Symbol;
+
+typedef struct KeyBlock {
+    struct KeyBlock* next;
+    size_t used;
+    size_t size;
+    char bytes[];
+} KeyBlock;
+
+/* Interned object keys. Each distinct key is stored once, so two interned
+ * keys are equal exactly when their pointers are equal. A table is not
+ * locked; use one per thread, or a local table per thread in front of a
+ * shared one. */
+typedef struct SymbolTable {
+    Symbol* slots;      /* Open addressing, capacity is a power of two */
+    size_t capacity;
+    size_t count;
+    KeyBlock* blocks;   /* Arena holding the key bytes */
+    struct SymbolTable* shared; /* Owner of the keys of a local table */
+    pthread_mutex_t lock;       /* Held by local tables adding to this one */
+} SymbolTable;
+
+SymbolTable* create_symbol_table(void);
+
+/* A per-thread cache in front of shared. The keys it returns are shared's,
+ * so they compare equal to keys interned through shared or any other local
+ * table; only a key new to this table takes shared's lock. shared itself
+ * must not be used directly while local tables are adding to it, and must
+ * outlive them. */
+SymbolTable* create_local_symbol_table(SymbolTable* shared);
+
+void free_symbol_table(SymbolTable* table);
+
+/* Return the table's copy of key[0, length), adding it on first use. The
+ * pointer stays valid until the table is freed. */
+const char* intern_key(SymbolTable* table, const char* key, size_t length);
+
+#endif /* SYMBOL_TABLE_H */